@@ -119,16 +119,13 @@ export async function saveDebug(): Promise<ApiResponse> {
 }
 
 // Log API
-export async function getLogList(): Promise<ApiResponse<LogListData>> {
-  return request<LogListData>('/api/log');
+export async function getLogList(cursor?: string): Promise<ApiResponse<LogListData>> {
+  const query = cursor ? `?cursor=${encodeURIComponent(cursor)}` : '';
+  return request<LogListData>(`/api/log${query}`);
 }
 
-export async function downloadLogChunk(
-  name: string,
-  offset: number,
-  size: number = 1024
-): Promise<ArrayBuffer> {
-  const res = await fetch(`${API_BASE}/api/log/download?name=${encodeURIComponent(name)}&offset=${offset}&size=${size}`, {
+export async function downloadLog(name: string): Promise<ArrayBuffer> {
+  const res = await fetch(`${API_BASE}/api/log/download?name=${encodeURIComponent(name)}`, {
     credentials: 'include',
   });
 
@@ -146,14 +143,25 @@ export async function downloadLogChunk(
 export async function firmwareBegin(
   target: string,
   name: string,
-  size: number
+  size: number,
+  sha256?: string
 ): Promise<ApiResponse> {
   return request('/api/firmware/begin', {
     method: 'POST',
-    body: JSON.stringify({ target, name, size }),
+    body: JSON.stringify({ target, name, size, sha256 }),
   });
 }
 
+// SHA-256 of the image as hex. crypto.subtle only exists in secure
+// contexts (HTTPS or localhost), so this returns undefined over plain HTTP.
+export async function firmwareDigest(data: Blob): Promise<string | undefined> {
+  if (!window.crypto?.subtle) return undefined;
+  const digest = await window.crypto.subtle.digest('SHA-256', await data.arrayBuffer());
+  return Array.from(new Uint8Array(digest))
+    .map((b) => b.toString(16).padStart(2, '0'))
+    .join('');
+}
+
 export async function firmwareUpload(
   offset: number,
   data: ArrayBuffer
@@ -169,6 +177,36 @@ export async function firmwareUpload(
   return res.json();
 }
 
+// Stream the whole image in one request (after firmwareBegin).
+// Uses XMLHttpRequest because fetch() cannot report upload progress.
+export function firmwareStream(
+  data: Blob,
+  onProgress?: (loaded: number, total: number) => void
+): Promise<ApiResponse<{ written: number }>> {
+  return new Promise((resolve, reject) => {
+    const xhr = new XMLHttpRequest();
+    xhr.open('POST', `${API_BASE}/api/firmware/stream`);
+    xhr.withCredentials = true;
+    xhr.setRequestHeader('Content-Type', 'application/octet-stream');
+    xhr.upload.onprogress = (e) => onProgress?.(e.loaded, e.total);
+    xhr.onload = () => {
+      if (xhr.status === 401) {
+        localStorage.removeItem('user');
+        window.location.reload();
+        reject(new Error('Unauthorized'));
+        return;
+      }
+      try {
+        resolve(JSON.parse(xhr.responseText));
+      } catch {
+        reject(new Error(`HTTP ${xhr.status}`));
+      }
+    };
+    xhr.onerror = () => reject(new Error('Network error'));
+    xhr.send(data);
+  });
+}
+
 // System API
 export async function reboot(): Promise<ApiResponse> {
   return request('/api/reboot', { method: 'POST' });
@@ -125,6 +125,14 @@ const translations = {
     'log.type.file': '文件',
     'log.type.memory': '内存',
     'log.totalSize': '总大小',
+    'log.live': '实时日志',
+    'log.live.start': '开始',
+    'log.live.stop': '停止',
+    'log.live.clear': '清空',
+    'log.live.level.info': '信息',
+    'log.live.level.debug': '调试',
+    'log.live.dropped': '已丢弃记录',
+    'log.live.empty': '等待新日志...',
 
     // Firmware
     'firmware.dropHint': '点击选择或拖放文件到此处',
@@ -161,6 +169,7 @@ const translations = {
     'error.1002': '资源冲突',
     'error.2000': '固件擦除失败',
     'error.2001': '固件写入失败',
+    'error.2002': '固件校验失败',
     'error.unknown': '未知错误',
     'error.networkError': '网络连接失败',
 
@@ -287,6 +296,14 @@ const translations = {
     'log.type.file': 'File',
     'log.type.memory': 'Memory',
     'log.totalSize': 'Total Size',
+    'log.live': 'Live Log',
+    'log.live.start': 'Start',
+    'log.live.stop': 'Stop',
+    'log.live.clear': 'Clear',
+    'log.live.level.info': 'Info',
+    'log.live.level.debug': 'Debug',
+    'log.live.dropped': 'Dropped records',
+    'log.live.empty': 'Waiting for new records...',
 
     // Firmware
     'firmware.dropHint': 'Click to select or drag & drop file here',
@@ -323,6 +340,7 @@ const translations = {
     'error.1002': 'Resource conflict',
     'error.2000': 'Firmware erase failed',
     'error.2001': 'Firmware write failed',
+    'error.2002': 'Firmware verification failed',
     'error.unknown': 'Unknown error',
     'error.networkError': 'Network connection failed',
 
@@ -1,6 +1,6 @@
 import { useState, useRef, useEffect } from 'preact/hooks';
 import { useI18n } from '../i18n';
-import { firmwareBegin, firmwareUpload, reboot, getSettings } from '../api';
+import { firmwareBegin, firmwareDigest, firmwareStream, reboot, getSettings } from '../api';
 import { Card, Button, ProgressBar } from '../components/ui';
 
 type UploadState = 'idle' | 'uploading' | 'success' | 'rebooting' | 'reconnecting';
@@ -55,31 +55,24 @@ export function FirmwarePage() {
 
     try {
       // Begin firmware upload
-      const beginRes = await firmwareBegin('controller', selectedFile.name, selectedFile.size);
+      const sha256 = await firmwareDigest(selectedFile);
+      const beginRes = await firmwareBegin('controller', selectedFile.name, selectedFile.size, sha256);
       if (!beginRes.ack) {
         setError(getErrorMessage(beginRes.error?.code, beginRes.error?.message));
         setState('idle');
         return;
       }
 
-      // Upload in chunks
-      const chunkSize = 4096;
-      const totalChunks = Math.ceil(selectedFile.size / chunkSize);
-
-      for (let i = 0; i < totalChunks; i++) {
-        const start = i * chunkSize;
-        const end = Math.min(start + chunkSize, selectedFile.size);
-        const chunk = await selectedFile.slice(start, end).arrayBuffer();
-
-        const uploadRes = await firmwareUpload(start, chunk);
-        if (!uploadRes.ack) {
-          setError(getErrorMessage(uploadRes.error?.code, uploadRes.error?.message));
-          setState('idle');
-          return;
-        }
-
-        setProgress(Math.round(((i + 1) / totalChunks) * 100));
+      // Stream the whole image in one request
+      const uploadRes = await firmwareStream(selectedFile, (loaded, total) => {
+        setProgress(Math.round((loaded / total) * 100));
+      });
+      if (!uploadRes.ack) {
+        setError(getErrorMessage(uploadRes.error?.code, uploadRes.error?.message));
+        setState('idle');
+        return;
       }
+      setProgress(100);
 
       // Success - show reboot prompt
       setState('success');
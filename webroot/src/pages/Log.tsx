@@ -1,25 +1,57 @@
 import { useState, useEffect } from 'preact/hooks';
 import { useI18n } from '../i18n';
-import { getLogList, downloadLogChunk } from '../api';
+import { getLogList, downloadLog } from '../api';
 import { Card, Button, StatCard } from '../components/ui';
-import type { LogEntry } from '../types';
+import type { LogEntry, LogPush } from '../types';
+
+const LIVE_MAX_LINES = 500;
 
 export function LogPage() {
   const { t } = useI18n();
   const [logs, setLogs] = useState<LogEntry[]>([]);
   const [loading, setLoading] = useState(true);
   const [downloading, setDownloading] = useState<string | null>(null);
+  const [live, setLive] = useState(false);
+  const [liveLevel, setLiveLevel] = useState<'info' | 'debug'>('info');
+  const [liveLines, setLiveLines] = useState<string[]>([]);
+  const [liveDropped, setLiveDropped] = useState(0);
 
   useEffect(() => {
     loadLogs();
   }, []);
 
+  // Live tail: a dedicated WebSocket, filtered by level on the server
+  useEffect(() => {
+    if (!live) return;
+    const protocol = window.location.protocol === 'https:' ? 'wss:' : 'ws:';
+    const websocket = new WebSocket(`${protocol}//${window.location.host}/ws?log=${liveLevel}`);
+
+    websocket.onmessage = (event) => {
+      try {
+        const msg = JSON.parse(event.data) as LogPush;
+        if (msg.type !== 'log') return;
+        const texts = msg.data.records.map((r) => r.text.replace(/\n$/, ''));
+        setLiveLines((prev) => prev.concat(texts).slice(-LIVE_MAX_LINES));
+        if (msg.data.dropped > 0) setLiveDropped((prev) => prev + msg.data.dropped);
+      } catch (error) {
+        console.error('Error parsing log message:', error);
+      }
+    };
+
+    return () => websocket.close();
+  }, [live, liveLevel]);
+
   const loadLogs = async () => {
     setLoading(true);
-    const res = await getLogList();
-    if (res.ack && res.data) {
-      setLogs(res.data.logs);
-    }
+    const all: LogEntry[] = [];
+    let cursor: string | undefined;
+    do {
+      const res = await getLogList(cursor);
+      if (!res.ack || !res.data) break;
+      all.push(...res.data.logs);
+      cursor = res.data.next;
+    } while (cursor);
+    setLogs(all);
     setLoading(false);
   };
 
@@ -42,34 +74,11 @@ export function LogPage() {
         // In simulator, this will fail gracefully
         window.open(`/api/log/download?name=${encodeURIComponent(log.name)}`, '_blank');
       } else {
-        // For memory type, download in chunks (binary data)
-        let chunks: Uint8Array[] = [];
-        let offset = 0;
-        const chunkSize = 1024;
-
-        while (offset < log.size) {
-          const buffer = await downloadLogChunk(log.name, offset, chunkSize);
-          if (buffer.byteLength === 0) break;
-
-          const bytes = new Uint8Array(buffer);
-          chunks.push(bytes);
-
-          offset += bytes.byteLength;
-
-          if (bytes.byteLength < chunkSize) break; // Last chunk
-        }
-
-        // Combine all chunks
-        const totalSize = chunks.reduce((sum, chunk) => sum + chunk.length, 0);
-        const combined = new Uint8Array(totalSize);
-        let position = 0;
-        for (const chunk of chunks) {
-          combined.set(chunk, position);
-          position += chunk.length;
-        }
+        // For memory type, fetch the whole log in one streamed response
+        const buffer = await downloadLog(log.name);
 
         // Create download
-        const blob = new Blob([combined], { type: 'application/octet-stream' });
+        const blob = new Blob([buffer], { type: 'application/octet-stream' });
         const url = URL.createObjectURL(blob);
         const a = document.createElement('a');
         a.href = url;
@@ -196,6 +205,40 @@ export function LogPage() {
           </Button>
         </div>
       </Card>
+
+      {/* Live Log */}
+      <Card title={t('log.live')} icon="📡">
+        <div class="flex flex-wrap items-center gap-3 mb-4">
+          <select
+            value={liveLevel}
+            onChange={(e) => setLiveLevel((e.target as HTMLSelectElement).value as 'info' | 'debug')}
+            class="px-4 py-2 border border-gray-200 rounded-lg bg-gray-50 focus:bg-white focus:ring-2 focus:ring-blue-500 focus:border-blue-500 transition-all"
+          >
+            <option value="info">{t('log.live.level.info')}</option>
+            <option value="debug">{t('log.live.level.debug')}</option>
+          </select>
+          <Button
+            onClick={() => setLive(!live)}
+            variant={live ? 'danger' : 'primary'}
+            icon={live ? '⏹️' : '▶️'}
+          >
+            {live ? t('log.live.stop') : t('log.live.start')}
+          </Button>
+          <Button
+            onClick={() => { setLiveLines([]); setLiveDropped(0); }}
+            variant="secondary"
+            icon="🧹"
+          >
+            {t('log.live.clear')}
+          </Button>
+          {liveDropped > 0 && (
+            <span class="text-sm text-amber-600">{t('log.live.dropped')}: {liveDropped}</span>
+          )}
+        </div>
+        <pre class="h-72 overflow-y-auto p-4 bg-gray-900 text-gray-100 text-xs font-mono rounded-lg whitespace-pre-wrap">
+          {liveLines.length > 0 ? liveLines.join('\n') : (live ? t('log.live.empty') : '')}
+        </pre>
+      </Card>
     </div>
   );
 }
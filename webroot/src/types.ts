@@ -143,6 +143,23 @@ export interface LogEntry {
 
 export interface LogListData {
   logs: LogEntry[];
+  next?: string; // Cursor for the next page, absent on the last one
+}
+
+// Live log tail push (/ws?log=...)
+export interface LogRecord {
+  seq: number;
+  level: number;
+  module: string;
+  text: string;
+}
+
+export interface LogPush {
+  type: 'log';
+  data: {
+    records: LogRecord[];
+    dropped: number;
+  };
 }
 
 // Login response
@@ -1,22 +1,42 @@
 #include "mongoose.h"
 #include "webserver_glue.h"
+#include "webserver_log.h"
+#include "webserver_reactor.h"
+
+#include <signal.h>
+
+static volatile sig_atomic_t s_signo;
+
+static void signal_handler(int signo) {
+  s_signo = signo;
+}
 
 int main(void) {
   struct mg_mgr mgr;
 
+  signal(SIGINT, signal_handler);
+  signal(SIGTERM, signal_handler);
+
   mg_mgr_init(&mgr);
   mg_log_set(MG_LL_DEBUG);
+  web_log_init(&mgr);
 
   // Initialize web server
   web_init(&mgr);
 
+  // Extra event loops (WEBSERVER_REACTORS > 1); this one stays reactor 0
+  web_reactors_start(&mgr);
+
   MG_INFO(("Starting Mongoose event loop..."));
 
-  // Infinite event loop
-  for (;;) {
+  // Event loop, until SIGINT / SIGTERM
+  while (s_signo == 0) {
     mg_mgr_poll(&mgr, 1000);
   }
 
+  MG_INFO(("Exiting on signal %d", (int) s_signo));
+  web_reactors_stop();  // Other event loops first, they post into this one
   mg_mgr_free(&mgr);
+  web_log_exit();  // Records still batched, including those from the close
   return 0;
 }
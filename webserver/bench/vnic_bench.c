@@ -0,0 +1,282 @@
+// Copyright (c) 2026
+// Virtual NIC Bench - Builtin TCP/IP stack over a simulated wire
+//
+// Two builtin-stack interfaces, 10.0.0.1 (server) and 10.0.0.2 (client),
+// are paired with web_vnic and polled from this thread. Each test reports
+// its rate, CPU time per Ethernet frame and the frames it took:
+//
+//   vnic_bench [loss_permille] [latency_ms] [reorder_permille] [pcap]
+//
+// The pcap file, if given, records what the client NIC sees.
+
+#include "mongoose.h"
+#include "webserver_vnic.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_DOWNLOAD_SIZE (1 << 20)
+#define BENCH_DOWNLOADS 4
+#define BENCH_CONNECTS 300
+#define BENCH_ROUNDS 5000UL
+#define BENCH_TIMEOUT 60.0            // Seconds per test step
+
+static struct mg_mgr s_mgr_srv, s_mgr_cli;
+static struct mg_tcpip_if s_if_srv, s_if_cli;
+static struct web_vnic s_vnic_srv, s_vnic_cli;
+
+static char s_download[BENCH_DOWNLOAD_SIZE];
+static char s_req[64];
+static size_t s_req_len;
+static size_t s_received;
+static unsigned long s_rounds;
+static bool s_done;
+
+static double wall_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static double cpu_seconds(void) {
+    return (double) clock() / CLOCKS_PER_SEC;
+}
+
+static unsigned long frames_sent(void) {
+    return s_vnic_srv.stats.sent + s_vnic_cli.stats.sent;
+}
+
+// -----------------------------------------------------------------------------
+// Server side (10.0.0.1)
+// -----------------------------------------------------------------------------
+static void http_srv_ev(struct mg_connection *c, int ev, void *ev_data) {
+    if (ev == MG_EV_HTTP_MSG) {
+        struct mg_http_message *hm = (struct mg_http_message *) ev_data;
+        if (mg_match(hm->uri, mg_str("/ws"), NULL)) {
+            mg_ws_upgrade(c, hm, NULL);
+        } else if (mg_match(hm->uri, mg_str("/download"), NULL)) {
+            mg_printf(c, "HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n",
+                      (int) sizeof(s_download));
+            mg_send(c, s_download, sizeof(s_download));
+        } else {
+            mg_http_reply(c, 404, "", "Not found\n");
+        }
+    } else if (ev == MG_EV_WS_MSG) {
+        struct mg_ws_message *wm = (struct mg_ws_message *) ev_data;
+        mg_ws_send(c, wm->data.buf, wm->data.len, WEBSOCKET_OP_BINARY);
+    }
+}
+
+// Modbus TCP stand-in: echo whatever arrives
+static void echo_srv_ev(struct mg_connection *c, int ev, void *ev_data) {
+    if (ev == MG_EV_READ) {
+        mg_send(c, c->recv.buf, c->recv.len);
+        c->recv.len = 0;
+    }
+    (void) ev_data;
+}
+
+// -----------------------------------------------------------------------------
+// Client side (10.0.0.2)
+// -----------------------------------------------------------------------------
+static void download_cli_ev(struct mg_connection *c, int ev, void *ev_data) {
+    if (ev == MG_EV_CONNECT) {
+        mg_printf(c, "GET /download HTTP/1.1\r\nHost: 10.0.0.1\r\n\r\n");
+    } else if (ev == MG_EV_HTTP_MSG) {
+        s_received += ((struct mg_http_message *) ev_data)->body.len;
+        c->is_closing = 1;
+        s_done = true;
+    } else if (ev == MG_EV_ERROR) {
+        printf("download: %s\n", (char *) ev_data);
+        s_done = true;
+    }
+}
+
+static void connect_cli_ev(struct mg_connection *c, int ev, void *ev_data) {
+    if (ev == MG_EV_CONNECT) {
+        s_rounds++;
+        c->is_closing = 1;
+    } else if (ev == MG_EV_CLOSE) {
+        s_done = true;
+    }
+    (void) ev_data;
+}
+
+static void echo_cli_ev(struct mg_connection *c, int ev, void *ev_data) {
+    if (ev == MG_EV_CONNECT) {
+        mg_send(c, s_req, s_req_len);
+    } else if (ev == MG_EV_READ && c->recv.len >= s_req_len) {
+        c->recv.len = 0;
+        if (++s_rounds >= BENCH_ROUNDS) {
+            c->is_closing = 1;
+            s_done = true;
+        } else {
+            mg_send(c, s_req, s_req_len);
+        }
+    }
+    (void) ev_data;
+}
+
+static void ws_cli_ev(struct mg_connection *c, int ev, void *ev_data) {
+    if (ev == MG_EV_WS_OPEN) {
+        mg_ws_send(c, s_req, s_req_len, WEBSOCKET_OP_BINARY);
+    } else if (ev == MG_EV_WS_MSG) {
+        if (++s_rounds >= BENCH_ROUNDS) {
+            c->is_closing = 1;
+            s_done = true;
+        } else {
+            mg_ws_send(c, s_req, s_req_len, WEBSOCKET_OP_BINARY);
+        }
+    }
+    (void) ev_data;
+}
+
+// -----------------------------------------------------------------------------
+// Driver
+// -----------------------------------------------------------------------------
+// The stack takes one frame per poll, so both managers spin at 0 ms
+static void poll_until_done(double timeout) {
+    double start = wall_seconds();
+    s_done = false;
+    while (!s_done && wall_seconds() - start < timeout) {
+        mg_mgr_poll(&s_mgr_srv, 0);
+        mg_mgr_poll(&s_mgr_cli, 0);
+    }
+}
+
+// Close what a step left behind, e.g. after a timeout, so that its late
+// events do not end the next step
+static void drain(void) {
+    struct mg_connection *c;
+    double start = wall_seconds();
+
+    for (c = s_mgr_cli.conns; c != NULL; c = c->next) c->is_closing = 1;
+    while (s_mgr_cli.conns != NULL && wall_seconds() - start < 1.0) {
+        mg_mgr_poll(&s_mgr_srv, 0);
+        mg_mgr_poll(&s_mgr_cli, 0);
+    }
+}
+
+struct bench_mark {
+    double wall, cpu;
+    unsigned long frames;
+};
+
+static void bench_start(struct bench_mark *m) {
+    m->wall = wall_seconds();
+    m->cpu = cpu_seconds();
+    m->frames = frames_sent();
+}
+
+static void bench_report(const char *name, const struct bench_mark *m,
+                         double units, const char *unit) {
+    double wall = wall_seconds() - m->wall;
+    double cpu = cpu_seconds() - m->cpu;
+    unsigned long frames = frames_sent() - m->frames;
+
+    drain();
+
+    printf("%-24s %10.1f %s/s %8.2f us CPU/frame %8lu frames\n", name,
+           units / wall, unit, frames ? cpu * 1e6 / (double) frames : 0.0,
+           frames);
+}
+
+static void if_setup(struct mg_tcpip_if *ifp, struct web_vnic *v,
+                     uint8_t host, uint8_t peer) {
+    ifp->driver = &web_vnic_driver;
+    ifp->driver_data = v;
+    ifp->ip = mg_htonl(MG_U32(10, 0, 0, host));
+    ifp->mask = mg_htonl(MG_U32(255, 255, 255, 0));
+    ifp->gw = mg_htonl(MG_U32(10, 0, 0, peer));
+    ifp->mac[0] = 2, ifp->mac[5] = host;
+}
+
+int main(int argc, char *argv[]) {
+    struct web_vnic_opts opts;
+    struct bench_mark m;
+    double start;
+    int i;
+
+    memset(&opts, 0, sizeof(opts));
+    if (argc > 1) opts.loss = (unsigned) atoi(argv[1]);
+    if (argc > 2) opts.latency_ms = (unsigned) atoi(argv[2]);
+    if (argc > 3) opts.reorder = (unsigned) atoi(argv[3]);
+
+    mg_log_set(MG_LL_ERROR);
+    mg_mgr_init(&s_mgr_srv);
+    mg_mgr_init(&s_mgr_cli);
+    if (!web_vnic_pair(&s_vnic_srv, &s_vnic_cli, &opts)) {
+        printf("web_vnic_pair() failed\n");
+        return EXIT_FAILURE;
+    }
+    if (argc > 4 && !web_vnic_capture(&s_vnic_cli, &mg_fs_posix, argv[4])) {
+        printf("Cannot write %s\n", argv[4]);
+        return EXIT_FAILURE;
+    }
+    if_setup(&s_if_srv, &s_vnic_srv, 1, 2);
+    if_setup(&s_if_cli, &s_vnic_cli, 2, 1);
+    mg_tcpip_init(&s_mgr_srv, &s_if_srv);
+    mg_tcpip_init(&s_mgr_cli, &s_if_cli);
+    mg_http_listen(&s_mgr_srv, "http://10.0.0.1:80", http_srv_ev, NULL);
+    mg_listen(&s_mgr_srv, "tcp://10.0.0.1:502", echo_srv_ev, NULL);
+
+    // Let both interfaces come up and settle their ARP probes
+    start = wall_seconds();
+    while (wall_seconds() - start < 1.5 ||
+           s_if_srv.state != MG_TCPIP_STATE_READY ||
+           s_if_cli.state != MG_TCPIP_STATE_READY) {
+        mg_mgr_poll(&s_mgr_srv, 0);
+        mg_mgr_poll(&s_mgr_cli, 0);
+    }
+    printf("wire: loss %u/1000, latency %u ms, reorder %u/1000\n", opts.loss,
+           opts.latency_ms, opts.reorder);
+
+    bench_start(&m);
+    s_received = 0;
+    for (i = 0; i < BENCH_DOWNLOADS; i++) {
+        mg_http_connect(&s_mgr_cli, "http://10.0.0.1:80/download",
+                        download_cli_ev, NULL);
+        poll_until_done(BENCH_TIMEOUT);
+    }
+    bench_report("HTTP 1 MB download", &m, (double) s_received / 1048576.0,
+                 "MB");
+
+    bench_start(&m);
+    s_rounds = 0;
+    for (i = 0; i < BENCH_CONNECTS; i++) {
+        mg_connect(&s_mgr_cli, "tcp://10.0.0.1:502", connect_cli_ev, NULL);
+        poll_until_done(5.0);
+    }
+    bench_report("TCP connect+close", &m, (double) s_rounds, "conn");
+
+    // Modbus TCP sized request and response
+    s_req_len = 12;
+    memset(s_req, 1, s_req_len);
+    bench_start(&m);
+    s_rounds = 0;
+    mg_connect(&s_mgr_cli, "tcp://10.0.0.1:502", echo_cli_ev, NULL);
+    poll_until_done(BENCH_TIMEOUT);
+    bench_report("Modbus 12 B round trip", &m, (double) s_rounds, "rt");
+
+    s_req_len = 64;
+    memset(s_req, 'x', s_req_len);
+    bench_start(&m);
+    s_rounds = 0;
+    mg_ws_connect(&s_mgr_cli, "ws://10.0.0.1:80/ws", ws_cli_ev, NULL, NULL);
+    poll_until_done(BENCH_TIMEOUT);
+    bench_report("WebSocket 64 B echo", &m, (double) s_rounds, "msg");
+
+    printf("srv->cli: sent %lu lost %lu reordered %lu overflow %lu\n",
+           s_vnic_srv.stats.sent, s_vnic_srv.stats.lost,
+           s_vnic_srv.stats.reordered, s_vnic_srv.stats.overflow);
+    printf("cli->srv: sent %lu lost %lu reordered %lu overflow %lu\n",
+           s_vnic_cli.stats.sent, s_vnic_cli.stats.lost,
+           s_vnic_cli.stats.reordered, s_vnic_cli.stats.overflow);
+
+    mg_mgr_free(&s_mgr_cli);
+    mg_mgr_free(&s_mgr_srv);
+    web_vnic_free(&s_vnic_cli);
+    web_vnic_free(&s_vnic_srv);
+    return EXIT_SUCCESS;
+}
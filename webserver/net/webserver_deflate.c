@@ -0,0 +1,249 @@
+// Copyright (c) 2026
+// Web Server Deflate - Streaming raw DEFLATE encoder (RFC 1951)
+
+#include "webserver_deflate.h"
+
+#include <string.h>
+
+#define MIN_MATCH 3
+#define MAX_MATCH 258
+#define END_OF_BLOCK 256
+
+// -----------------------------------------------------------------------------
+// RFC 1951 3.2.5: length and distance code tables
+// -----------------------------------------------------------------------------
+static const uint16_t s_len_base[29] = {
+    3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t s_len_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+    2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t s_dist_base[30] = {
+    1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+    33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+    1025, 1537, 2049, 3073, 4097, 6145,  8193,  12289, 16385, 24577};
+static const uint8_t s_dist_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+    6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// -----------------------------------------------------------------------------
+// Bit output
+// -----------------------------------------------------------------------------
+// Callers reserve worst-case space up front, so bytes are stored directly
+static void put_bits(struct web_deflate *d, struct mg_iobuf *out,
+                     uint32_t val, int n) {
+    d->bitbuf |= val << d->bitcnt;
+    d->bitcnt += n;
+    while (d->bitcnt >= 8) {
+        out->buf[out->len++] = (uint8_t) d->bitbuf;
+        d->bitbuf >>= 8;
+        d->bitcnt -= 8;
+    }
+}
+
+// Huffman codes are defined MSB first, the bit stream is LSB first
+static uint32_t bit_reverse(uint32_t code, int n) {
+    uint32_t r = 0;
+    while (n-- > 0) {
+        r = (r << 1) | (code & 1);
+        code >>= 1;
+    }
+    return r;
+}
+
+// RFC 1951 3.2.6: fixed literal/length code
+static void put_symbol(struct web_deflate *d, struct mg_iobuf *out,
+                       unsigned sym) {
+    if (sym < 144) {
+        put_bits(d, out, bit_reverse(0x30 + sym, 8), 8);
+    } else if (sym < 256) {
+        put_bits(d, out, bit_reverse(0x190 + sym - 144, 9), 9);
+    } else if (sym < 280) {
+        put_bits(d, out, bit_reverse(sym - 256, 7), 7);
+    } else {
+        put_bits(d, out, bit_reverse(0xc0 + sym - 280, 8), 8);
+    }
+}
+
+static void put_match(struct web_deflate *d, struct mg_iobuf *out,
+                      size_t len, size_t dist) {
+    int i = 28, j = 29;
+    while (s_len_base[i] > len) i--;
+    put_symbol(d, out, 257 + (unsigned) i);
+    put_bits(d, out, (uint32_t) (len - s_len_base[i]), s_len_extra[i]);
+    while (s_dist_base[j] > dist) j--;
+    put_bits(d, out, bit_reverse((uint32_t) j, 5), 5);
+    put_bits(d, out, (uint32_t) (dist - s_dist_base[j]), s_dist_extra[j]);
+}
+
+// Reserve room for len input bytes: 9 bits per literal at worst, plus block
+// headers, end-of-block codes and the sync flush marker
+static bool reserve(struct mg_iobuf *out, size_t len) {
+    size_t need = out->len + len + len / 8 + 16;
+    return need <= out->size || mg_iobuf_resize(out, need);
+}
+
+// -----------------------------------------------------------------------------
+// LZ77 matcher
+// -----------------------------------------------------------------------------
+static size_t hash3(const struct web_deflate *d, const uint8_t *p) {
+    uint32_t v = (uint32_t) p[0] | ((uint32_t) p[1] << 8) |
+                 ((uint32_t) p[2] << 16);
+    return (size_t) ((v * 2654435761U) >> 16) & d->hmask;
+}
+
+static void insert(struct web_deflate *d, size_t pos) {
+    size_t h = hash3(d, d->window + pos);
+    d->prev[pos & (d->wsize - 1)] = d->head[h];
+    d->head[h] = (uint16_t) pos;
+}
+
+static size_t longest_match(const struct web_deflate *d, size_t *dist) {
+    const uint8_t *win = d->window, *cur = win + d->pos;
+    size_t avail = d->fill - d->pos;
+    size_t max_len = avail < MAX_MATCH ? avail : MAX_MATCH;
+    size_t best = 0, cand = d->head[hash3(d, cur)];
+    int chain = WEB_DEFLATE_MAX_CHAIN;
+
+    // Distances stay below wsize, so prev[] entries are never stale
+    while (cand != 0 && cand < d->pos && d->pos - cand < d->wsize &&
+           chain-- > 0) {
+        const uint8_t *p = win + cand;
+        size_t n = 0;
+        if (p[best] == cur[best]) {
+            while (n < max_len && p[n] == cur[n]) n++;
+            if (n > best) {
+                best = n;
+                *dist = d->pos - cand;
+                if (n == max_len) break;
+            }
+        }
+        cand = d->prev[cand & (d->wsize - 1)];
+    }
+    return best;
+}
+
+// Encode everything between pos and fill
+static void compress_window(struct web_deflate *d, struct mg_iobuf *out) {
+    while (d->pos < d->fill) {
+        size_t avail = d->fill - d->pos, len = 0, dist = 0;
+        if (avail >= MIN_MATCH) {
+            len = longest_match(d, &dist);
+            insert(d, d->pos);
+        }
+        if (len >= MIN_MATCH) {
+            size_t end = d->pos + len;
+            put_match(d, out, len, dist);
+            for (d->pos++; d->pos < end; d->pos++) {
+                if (d->fill - d->pos >= MIN_MATCH) insert(d, d->pos);
+            }
+        } else {
+            put_symbol(d, out, d->window[d->pos++]);
+        }
+    }
+}
+
+// Drop the oldest half of the window and rebase hash positions
+static void slide(struct web_deflate *d) {
+    size_t i, w = d->wsize;
+    memmove(d->window, d->window + w, w);
+    d->fill -= w;
+    d->pos -= w;
+    for (i = 0; i <= d->hmask; i++) {
+        d->head[i] = (uint16_t) (d->head[i] >= w ? d->head[i] - w : 0);
+    }
+    for (i = 0; i < w; i++) {
+        d->prev[i] = (uint16_t) (d->prev[i] >= w ? d->prev[i] - w : 0);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+size_t web_deflate_mem(int window_bits) {
+    size_t w = (size_t) 1 << window_bits;
+    // window (2w) + prev (w entries) + head (w / 2 entries)
+    return 2 * w + w * sizeof(uint16_t) + (w / 2) * sizeof(uint16_t);
+}
+
+int web_deflate_bits_for(size_t mem_max) {
+    int bits;
+    for (bits = WEB_DEFLATE_MAX_BITS; bits >= WEB_DEFLATE_MIN_BITS; bits--) {
+        if (web_deflate_mem(bits) <= mem_max) return bits;
+    }
+    return 0;
+}
+
+bool web_deflate_init(struct web_deflate *d, int window_bits) {
+    memset(d, 0, sizeof(*d));
+    if (window_bits < WEB_DEFLATE_MIN_BITS ||
+        window_bits > WEB_DEFLATE_MAX_BITS) {
+        return false;
+    }
+    d->window_bits = window_bits;
+    d->wsize = (size_t) 1 << window_bits;
+    d->hmask = d->wsize / 2 - 1;
+    d->window = (uint8_t *) mg_calloc(2, d->wsize);
+    d->prev = (uint16_t *) mg_calloc(d->wsize, sizeof(uint16_t));
+    d->head = (uint16_t *) mg_calloc(d->hmask + 1, sizeof(uint16_t));
+    if (d->window == NULL || d->prev == NULL || d->head == NULL) {
+        web_deflate_free(d);
+        return false;
+    }
+    return true;
+}
+
+void web_deflate_free(struct web_deflate *d) {
+    mg_free(d->window);
+    mg_free(d->prev);
+    mg_free(d->head);
+    d->window = NULL;
+    d->prev = d->head = NULL;
+}
+
+void web_deflate_reset(struct web_deflate *d) {
+    memset(d->head, 0, (d->hmask + 1) * sizeof(uint16_t));
+    d->fill = d->pos = 0;
+}
+
+bool web_deflate_sync(struct web_deflate *d, const void *buf, size_t len,
+                      struct mg_iobuf *out) {
+    const uint8_t *p = (const uint8_t *) buf;
+    size_t start = out->len;
+
+    if (!reserve(out, len)) return false;
+    d->in_bytes += len;
+
+    put_bits(d, out, 0, 1);  // BFINAL = 0
+    put_bits(d, out, 1, 2);  // BTYPE = 01, fixed Huffman codes
+    while (len > 0) {
+        size_t n;
+        if (d->fill == 2 * d->wsize) slide(d);
+        n = 2 * d->wsize - d->fill;
+        if (n > len) n = len;
+        memcpy(d->window + d->fill, p, n);
+        d->fill += n, p += n, len -= n;
+        compress_window(d, out);
+    }
+    put_symbol(d, out, END_OF_BLOCK);
+
+    // Sync flush: empty stored block, byte aligned, LEN = 0, NLEN = 0xffff
+    put_bits(d, out, 0, 3);
+    if (d->bitcnt > 0) put_bits(d, out, 0, 8 - d->bitcnt);
+    put_bits(d, out, 0, 16);
+    put_bits(d, out, 0xffff, 16);
+
+    d->out_bytes += out->len - start;
+    return true;
+}
+
+bool web_deflate_finish(struct web_deflate *d, struct mg_iobuf *out) {
+    size_t start = out->len;
+    if (!reserve(out, 0)) return false;
+    put_bits(d, out, 1, 1);  // BFINAL = 1
+    put_bits(d, out, 1, 2);  // BTYPE = 01
+    put_symbol(d, out, END_OF_BLOCK);
+    if (d->bitcnt > 0) put_bits(d, out, 0, 8 - d->bitcnt);
+    d->out_bytes += out->len - start;
+    return true;
+}
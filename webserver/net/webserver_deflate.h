@@ -0,0 +1,66 @@
+// Copyright (c) 2026
+// Web Server Deflate - Streaming raw DEFLATE encoder (RFC 1951)
+#pragma once
+
+#include "mongoose.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------------
+// Configuration
+// -----------------------------------------------------------------------------
+#define WEB_DEFLATE_MIN_BITS 9    // Smallest window zlib-based peers accept
+#define WEB_DEFLATE_MAX_BITS 15   // RFC 1951 maximum: 32 KB window
+
+#ifndef WEB_DEFLATE_MAX_CHAIN
+#define WEB_DEFLATE_MAX_CHAIN 8   // Hash chain entries probed per position
+#endif
+
+// -----------------------------------------------------------------------------
+// Encoder state
+// -----------------------------------------------------------------------------
+// The history window is kept across calls ("context takeover"), so repeated
+// JSON keys in consecutive messages compress to short back-references.
+// Output uses fixed Huffman codes only, which keeps the encoder small and
+// its memory footprint exactly web_deflate_mem(window_bits).
+struct web_deflate {
+    uint8_t *window;     // 2 * wsize bytes: history followed by new input
+    uint16_t *head;      // Hash bucket -> most recent position (0 = none)
+    uint16_t *prev;      // Position -> previous position with same hash
+    size_t wsize;        // History window size (1 << window_bits)
+    size_t hmask;        // Hash table mask
+    size_t fill;         // Bytes currently held in window
+    size_t pos;          // Next window position to encode
+    uint32_t bitbuf;     // Pending output bits, LSB first
+    int bitcnt;          // Number of pending bits
+    int window_bits;     // Negotiated window size, log2
+    uint64_t in_bytes;   // Total uncompressed bytes consumed
+    uint64_t out_bytes;  // Total compressed bytes produced
+};
+
+// Memory needed by an encoder with the given window, in bytes
+size_t web_deflate_mem(int window_bits);
+
+// Largest window (in bits) whose encoder fits into mem_max bytes, 0 if none
+int web_deflate_bits_for(size_t mem_max);
+
+// Allocate encoder buffers; returns false on OOM or invalid window_bits
+bool web_deflate_init(struct web_deflate *d, int window_bits);
+void web_deflate_free(struct web_deflate *d);
+
+// Drop the history window (no context takeover)
+void web_deflate_reset(struct web_deflate *d);
+
+// Compress len bytes, append to out and terminate with a sync flush, i.e.
+// an empty stored block ending in 00 00 ff ff. Output is byte-aligned.
+bool web_deflate_sync(struct web_deflate *d, const void *buf, size_t len,
+                      struct mg_iobuf *out);
+
+// Append a final empty block, terminating the DEFLATE stream
+bool web_deflate_finish(struct web_deflate *d, struct mg_iobuf *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -34,6 +34,7 @@ extern "C" {
 #define ERR_RESOURCE_CONFLICT 1002 // Resource conflict
 #define ERR_OTA_BEGIN_FAILED 2000  // OTA begin failed (flash erase)
 #define ERR_OTA_WRITE_FAILED 2001  // OTA write failed
+#define ERR_OTA_VERIFY_FAILED 2002 // OTA image SHA-256 mismatch
 
 // -----------------------------------------------------------------------------
 // Glue Layer Functions
@@ -5,6 +5,12 @@
 
 #include "webserver_glue.h"
 #include "webserver_impl.h"
+#include "webserver_log.h"
+#include "webserver_logstore.h"
+#include "webserver_reactor.h"
+#include "webserver_snapshot.h"
+#include "webserver_tcpstats.h"
+#include "webserver_udpfwd.h"
 
 #include <string.h>
 #include <time.h>
@@ -39,43 +45,40 @@ static const char *s_device_ip = "192.168.1.100";
 static const char *s_device_mac = "AA:BB:CC:DD:EE:FF";
 
 // Simulated tool info
-static int s_tool_state = 1;  // 0=offline, 1=connecting, 2=online
-static bool s_tool_change = false;
 static const char *s_tool_name = "工具-01";
 static const char *s_tool_firmware = "1.2.0";
 static const char *s_tool_hardware = "1.0";
 static const char *s_tool_model = "TYPE-A";
 static const char *s_tool_serial = "TL123456";
 
-// Simulated memory stats
-static int s_sram_used = 45;
-static int s_sram_max = 67;
-static int s_sdram_used = 32;
-static int s_sdram_max = 58;
-
 // Timezone offset (hours from UTC)
 static int s_tz_offset = 8;
 
-// Debug module: TCP connection states
-static struct {
+// Live device status: written by device tasks, read by handlers and timers
+// through web_snapshot_read(), so neither side ever waits for the other
+struct sim_tcp_conn {
     bool connected;
     char ip[20];
     int port;
-} s_tcp_custom[2] = {
-    {true, "192.168.1.50", 8080},
-    {false, "", 0}
 };
 
-static struct {
-    bool connected;
-    char ip[20];
-    int port;
-} s_tcp_mbtcp[3] = {
-    {true, "192.168.1.51", 502},
-    {true, "192.168.1.52", 502},
-    {false, "", 0}
+struct sim_status {
+    int tool_state;             // 0=offline, 1=connecting, 2=online
+    unsigned tool_changes;      // Bumped on every tool swap
+    int sram_used, sram_max;
+    int sdram_used, sdram_max;
+    struct sim_tcp_conn tcp_custom[2];   // Debug module: TCP connection states
+    struct sim_tcp_conn tcp_mbtcp[3];
 };
 
+static const struct sim_status s_status_init = {
+    1, 0, 45, 67, 32, 58,
+    {{true, "192.168.1.50", 8080}, {false, "", 0}},
+    {{true, "192.168.1.51", 502}, {true, "192.168.1.52", 502}, {false, "", 0}}
+};
+static struct web_snapshot s_status;
+static unsigned s_tool_seen;    // tool_changes last reported by /api/tool
+
 // Debug module: UDP target IP
 static char s_udp_target_ip[20] = "192.168.1.100";
 
@@ -95,34 +98,55 @@ static struct {
     bool udp_log;
 } s_udp_forward = {0};
 
+// Channel mask for web_udpfwd_set_mask(), bit order = port order
+static unsigned udp_forward_mask(void) {
+    const bool *flags[WEB_UDPFWD_CHANNELS] = {
+        &s_udp_forward.tool_rx, &s_udp_forward.tool_tx,
+        &s_udp_forward.screen_rx, &s_udp_forward.screen_tx,
+        &s_udp_forward.op1_rx, &s_udp_forward.op1_tx,
+        &s_udp_forward.op2_rx, &s_udp_forward.op2_tx,
+        &s_udp_forward.mbtcp1_rx, &s_udp_forward.mbtcp1_tx,
+        &s_udp_forward.mbtcp2_rx, &s_udp_forward.mbtcp2_tx,
+        &s_udp_forward.mbtcp3_rx, &s_udp_forward.mbtcp3_tx,
+        &s_udp_forward.udp_log
+    };
+    unsigned i, mask = 0;
+    for (i = 0; i < WEB_UDPFWD_CHANNELS; i++) {
+        if (*flags[i]) mask |= 1U << i;
+    }
+    return mask;
+}
+
 // Debug module: Operation log flags
 static struct {
     bool io, mbtcp, op, tool, screen;
 } s_op_log = {0};
 
-// Log module: Memory log entries (file logs are read from simulate/Logs directory)
-static struct {
-    const char *name;
-    int size;
-    const char *type;  // "memory" only - file logs are dynamic
-} s_memory_logs[] = {
-    {"boot.log",    8192,   "memory"},
-    {"recent.log",  16384,  "memory"},
-    {NULL, 0, NULL}
-};
+// Log module: Memory logs (file logs are read from simulate/Logs directory)
+static const char *s_memory_logs[] = {"boot.log", "recent.log", NULL};
 
-// Simulated memory log content (for boot.log / recent.log)
+// Simulated memory log content (for boot.log)
 static const char *s_boot_log_content =
     "[2026-02-01 10:00:00] INFO: System started\n"
     "[2026-02-01 10:00:01] INFO: Hardware initialized\n"
     "[2026-02-01 10:00:02] INFO: Network ready\n"
     "[2026-02-01 10:00:03] INFO: Web server started\n";
 
-static const char *s_recent_log_content =
-    "[2026-02-01 10:05:00] INFO: User admin logged in\n"
-    "[2026-02-01 10:05:15] INFO: Settings updated\n"
-    "[2026-02-01 10:05:30] DEBUG: Tool status check\n"
-    "[2026-02-01 10:06:00] INFO: Dashboard accessed\n";
+// Log module: recent.log is backed by a persistent segmented store
+#define SIM_STORE_DIR "webserver/simulate/LogStore"
+static struct web_logstore s_log_store;
+static bool s_log_store_ok = false;
+static time_t s_recent_mtime = 0;  // Last append, for the download ETag
+static time_t s_boot_time = 0;
+
+// Log module: record sources, names used by /ws?log=...&modules=...
+enum {
+    SIM_LOG_SYSTEM, SIM_LOG_WEB, SIM_LOG_IO, SIM_LOG_MBTCP,
+    SIM_LOG_OP, SIM_LOG_TOOL, SIM_LOG_SCREEN, SIM_LOG_UDP
+};
+const char *s_log_modules[] = {
+    "system", "web", "io", "mbtcp", "op", "tool", "screen", "udp", NULL
+};
 
 // Simulated settings
 static int s_language = 0;        // 0=Chinese, 1=English
@@ -139,6 +163,36 @@ static char s_device_hardware_buf[32] = "2.0";
 static char s_device_serial_buf[32] = "SN123456";
 static char s_device_ip_buf[20] = "192.168.1.100";
 
+// -----------------------------------------------------------------------------
+// Device Log
+// -----------------------------------------------------------------------------
+// Format a "[YYYY-MM-DD HH:MM:SS] LEVEL: message" line, stream it to log
+// subscribers and the udp_log forward channel and, unless it is DEBUG
+// traffic, append it to the log store
+static void sim_log(int level, int module, const char *fmt, ...) {
+    static const char *names[] = {"NONE", "ERROR", "INFO", "DEBUG", "VERBOSE"};
+    char line[WEB_LOGSTORE_MAX_TEXT];
+    time_t now = time(NULL), local = now + (time_t) s_tz_offset * 3600;
+    size_t n, max = sizeof(line) - 1;  // Room for the newline
+    va_list ap;
+
+    n = strftime(line, max, "[%Y-%m-%d %H:%M:%S] ", gmtime(&local));
+    n += mg_snprintf(line + n, max - n, "%s: ", names[level]);
+    if (n < max) {
+        va_start(ap, fmt);
+        n += mg_vsnprintf(line + n, max - n, fmt, &ap);
+        va_end(ap);
+    }
+    if (n > max - 1) n = max - 1;
+    line[n++] = '\n';
+    ws_log_publish(level, module, line, n);
+    web_udpfwd_capture(WEB_UDPFWD_LOG, line, n);
+    if (s_log_store_ok && level <= MG_LL_INFO &&
+        web_logstore_append(&s_log_store, now, level, module, line, n) != 0) {
+        s_recent_mtime = now;
+    }
+}
+
 // -----------------------------------------------------------------------------
 // Authentication
 // -----------------------------------------------------------------------------
@@ -147,7 +201,7 @@ struct user *glue_authenticate(struct mg_http_message *hm) {
     struct user *u, *result = NULL;
 
     mg_http_creds(hm, user, sizeof(user), pass, sizeof(pass));
-    MG_DEBUG(("Auth: user=[%s] pass=[%s]", user, pass));
+    MG_DEBUG(("Auth: user=[%s]", user));
 
     if (user[0] != '\0' && pass[0] != '\0') {
         // Basic Auth: search by user/password
@@ -165,6 +219,9 @@ struct user *glue_authenticate(struct mg_http_message *hm) {
         }
     }
 
+    if (result != NULL && mg_match(hm->uri, mg_str("/api/login"), NULL)) {
+        sim_log(MG_LL_INFO, SIM_LOG_WEB, "User %s logged in", result->name);
+    }
     return result;
 }
 
@@ -183,13 +240,16 @@ static void handle_dashboard(struct mg_connection *c,
 
     char json[1024];
     time_t now = time(NULL);
+    struct sim_status st;
+
+    web_snapshot_read(&s_status, &st);
 
     // Return all dashboard data in one response:
     // - device info
     // - network info
     // - tool info (initial state)
     // - real-time status (same as WebSocket push, for initial load)
-    if (s_tool_state == 0) {
+    if (st.tool_state == 0) {
         mg_snprintf(json, sizeof(json),
             "{\"device\":{\"name\":%m,\"firmware\":%m,\"hardware\":%m,\"serial\":%m},"
             "\"network\":{\"ip\":%m,\"mac\":%m},"
@@ -201,8 +261,8 @@ static void handle_dashboard(struct mg_connection *c,
             MG_ESC(s_device_hardware), MG_ESC(s_device_serial),
             MG_ESC(s_device_ip), MG_ESC(s_device_mac),
             (unsigned long)now, s_tz_offset,
-            s_sram_used, s_sram_max, s_sdram_used, s_sdram_max,
-            s_tool_state);
+            st.sram_used, st.sram_max, st.sdram_used, st.sdram_max,
+            st.tool_state);
     } else {
         mg_snprintf(json, sizeof(json),
             "{\"device\":{\"name\":%m,\"firmware\":%m,\"hardware\":%m,\"serial\":%m},"
@@ -215,11 +275,11 @@ static void handle_dashboard(struct mg_connection *c,
             MG_ESC(s_device_name), MG_ESC(s_device_firmware),
             MG_ESC(s_device_hardware), MG_ESC(s_device_serial),
             MG_ESC(s_device_ip), MG_ESC(s_device_mac),
-            s_tool_state, MG_ESC(s_tool_name), MG_ESC(s_tool_firmware),
+            st.tool_state, MG_ESC(s_tool_name), MG_ESC(s_tool_firmware),
             MG_ESC(s_tool_hardware), MG_ESC(s_tool_model), MG_ESC(s_tool_serial),
             (unsigned long)now, s_tz_offset,
-            s_sram_used, s_sram_max, s_sdram_used, s_sdram_max,
-            s_tool_state);
+            st.sram_used, st.sram_max, st.sdram_used, st.sdram_max,
+            st.tool_state);
     }
     api_reply_ok(c, json);
 }
@@ -231,11 +291,14 @@ static void handle_tool(struct mg_connection *c,
     (void) u;
 
     char json[512];
+    struct sim_status st;
+
+    web_snapshot_read(&s_status, &st);
 
     // Clear tool_change flag after API call
-    s_tool_change = false;
+    s_tool_seen = st.tool_changes;
 
-    if (s_tool_state == 0) {
+    if (st.tool_state == 0) {
         // Offline: only return state
         mg_snprintf(json, sizeof(json), "{\"state\":0}");
     } else {
@@ -243,7 +306,7 @@ static void handle_tool(struct mg_connection *c,
         mg_snprintf(json, sizeof(json),
             "{\"state\":%d,\"name\":%m,\"firmware\":%m,"
             "\"hardware\":%m,\"model\":%m,\"serial\":%m}",
-            s_tool_state, MG_ESC(s_tool_name), MG_ESC(s_tool_firmware),
+            st.tool_state, MG_ESC(s_tool_name), MG_ESC(s_tool_firmware),
             MG_ESC(s_tool_hardware), MG_ESC(s_tool_model), MG_ESC(s_tool_serial));
     }
     api_reply_ok(c, json);
@@ -290,6 +353,7 @@ static void handle_settings_system(struct mg_connection *c,
 
     MG_INFO(("Settings/system updated: lang=%d unit=%d start=%d activ=%d barcode=%d tz=%d",
              s_language, s_unit, s_start_mode, s_activation_mode, s_barcode_mode, s_tz_offset));
+    sim_log(MG_LL_INFO, SIM_LOG_WEB, "System settings updated");
     api_reply_ok(c, NULL);
 }
 
@@ -317,6 +381,7 @@ static void handle_settings_ver(struct mg_connection *c,
 
     MG_INFO(("Settings/ver updated: name=%s hw=%s sn=%s",
              s_device_name_buf, s_device_hardware_buf, s_device_serial_buf));
+    sim_log(MG_LL_INFO, SIM_LOG_WEB, "Device info updated");
     api_reply_ok(c, NULL);
 }
 
@@ -336,6 +401,8 @@ static void handle_settings_network(struct mg_connection *c,
 
     MG_INFO(("Settings/network updated: ip=%s mbtcp=%d custom=%d",
              s_device_ip_buf, s_mbtcp_port, s_custom_port));
+    sim_log(MG_LL_INFO, SIM_LOG_WEB, "Network settings updated: ip=%s",
+            s_device_ip_buf);
     api_reply_ok(c, NULL);
 }
 
@@ -356,6 +423,55 @@ static char s_fw_name[64] = "";
 static size_t s_fw_size = 0;
 static size_t s_fw_written = 0;
 
+// Image integrity: SHA-256 is updated as bytes are written, so verifying
+// the image never needs a second pass over external flash
+static mg_sha256_ctx s_fw_sha;
+static char s_fw_sha_expected[65] = "";  // Hex digest from begin, "" = none
+static bool s_fw_verified = false;       // s_fw_sha finalized, result below
+static int s_fw_verify_err = 0;
+
+static void fw_reset(void) {
+    s_fw_written = 0;
+    s_fw_verified = false;
+    s_fw_verify_err = 0;
+    mg_sha256_init(&s_fw_sha);
+}
+
+static void fw_write(size_t offset, const void *buf, size_t len) {
+    // Simulate flash write
+    if (s_fw_sha_expected[0] != '\0') {
+        mg_sha256_update(&s_fw_sha, (const unsigned char *) buf, len);
+    }
+    s_fw_written = offset + len;
+}
+
+// Called once the last byte is written. The digest can only be finalized
+// once, so later calls for the same image return the first result.
+static int fw_verify(void) {
+    unsigned char digest[32];
+    char hex[65];
+
+    if (s_fw_written != s_fw_size) return ERR_OTA_WRITE_FAILED;
+    if (s_fw_sha_expected[0] == '\0') return 0;
+    if (s_fw_verified) return s_fw_verify_err;
+
+    s_fw_verified = true;
+    mg_sha256_final(digest, &s_fw_sha);
+    for (int i = 0; i < 32; i++) {
+        mg_snprintf(hex + i * 2, 3, "%02x", digest[i]);
+    }
+    if (mg_strcasecmp(mg_str(hex), mg_str(s_fw_sha_expected)) != 0) {
+        MG_ERROR(("Firmware SHA-256 mismatch: got %s, expected %s",
+                  hex, s_fw_sha_expected));
+        sim_log(MG_LL_ERROR, SIM_LOG_SYSTEM, "Firmware %s failed verification",
+                s_fw_name);
+        s_fw_verify_err = ERR_OTA_VERIFY_FAILED;
+        return s_fw_verify_err;
+    }
+    MG_INFO(("Firmware SHA-256 verified: %s", hex));
+    return 0;
+}
+
 static void handle_firmware_begin(struct mg_connection *c,
                                   struct mg_http_message *hm,
                                   struct user *u) {
@@ -363,27 +479,49 @@ static void handle_firmware_begin(struct mg_connection *c,
 
     char *target = mg_json_get_str(hm->body, "$.target");
     char *name = mg_json_get_str(hm->body, "$.name");
+    char *sha256 = mg_json_get_str(hm->body, "$.sha256");
     long size = mg_json_get_long(hm->body, "$.size", 0);
 
     // Validate target
     if (target == NULL || strcmp(target, "controller") != 0) {
         if (target) mg_free(target);
         if (name) mg_free(name);
+        if (sha256) mg_free(sha256);
         api_reply_fail(c, ERR_INVALID_PARAM, "Unsupported target");
         return;
     }
 
+    // Optional expected digest: 64 hex characters
+    s_fw_sha_expected[0] = '\0';
+    if (sha256) {
+        size_t n = strlen(sha256), i = 0;
+        while (i < n && strchr("0123456789abcdefABCDEF", sha256[i]) != NULL) i++;
+        if (n != 64 || i != n) {
+            mg_free(target);
+            if (name) mg_free(name);
+            mg_free(sha256);
+            api_reply_fail(c, ERR_INVALID_PARAM, "Invalid sha256");
+            return;
+        }
+        mg_snprintf(s_fw_sha_expected, sizeof(s_fw_sha_expected), "%s", sha256);
+        mg_free(sha256);
+    }
+
     // Store firmware info
     if (name) {
         mg_snprintf(s_fw_name, sizeof(s_fw_name), "%s", name);
         mg_free(name);
     }
     s_fw_size = (size_t) size;
-    s_fw_written = 0;
+    fw_reset();
 
     mg_free(target);
 
-    MG_INFO(("Firmware begin: name=%s size=%lu", s_fw_name, (unsigned long) s_fw_size));
+    MG_INFO(("Firmware begin: name=%s size=%lu sha256=%s", s_fw_name,
+             (unsigned long) s_fw_size,
+             s_fw_sha_expected[0] ? s_fw_sha_expected : "-"));
+    sim_log(MG_LL_INFO, SIM_LOG_SYSTEM, "Firmware update started: %s (%lu bytes)",
+            s_fw_name, (unsigned long) s_fw_size);
 
     // Simulate flash erase
     api_reply_ok(c, NULL);
@@ -407,12 +545,36 @@ static void handle_firmware_upload(struct mg_connection *c,
 
     size_t len = hm->body.len;
 
-    // Simulate flash write
-    s_fw_written = (size_t) offset + len;
+    // The running hash needs chunks in order and within the image, so
+    // only digest-verified uploads enforce it. A retry of the chunk just
+    // written (its reply was lost) is acknowledged without hashing it twice.
+    bool resend = false;
+    if (s_fw_sha_expected[0] != '\0' &&
+        ((size_t) offset != s_fw_written || (size_t) offset + len > s_fw_size)) {
+        if (len == 0 || (size_t) offset + len != s_fw_written) {
+            api_reply_fail(c, ERR_INVALID_PARAM, "Invalid offset");
+            return;
+        }
+        resend = true;
+    }
+
+    if (!resend) {
+        fw_write((size_t) offset, hm->body.buf, len);
+    }
 
-    MG_INFO(("Firmware upload: offset=%ld len=%lu total_written=%lu/%lu",
+    MG_INFO(("Firmware upload: offset=%ld len=%lu total_written=%lu/%lu%s",
              offset, (unsigned long) len,
-             (unsigned long) s_fw_written, (unsigned long) s_fw_size));
+             (unsigned long) s_fw_written, (unsigned long) s_fw_size,
+             resend ? " (resend)" : ""));
+
+    // A resend of the last chunk gets the cached verification result
+    if (s_fw_written >= s_fw_size) {
+        int err = fw_verify();
+        if (err != 0) {
+            api_reply_fail(c, err, "Firmware verification failed");
+            return;
+        }
+    }
 
     char json[128];
     mg_snprintf(json, sizeof(json), "{\"offset\":%ld,\"written\":%lu}",
@@ -420,6 +582,45 @@ static void handle_firmware_upload(struct mg_connection *c,
     api_reply_ok(c, json);
 }
 
+// Streaming upload: whole image in one POST /api/firmware/stream after
+// /api/firmware/begin. Flash is programmed in whole pages, so a partial
+// page is held back in c->recv until the rest of it arrives.
+#define SIM_FLASH_PAGE_SIZE 512
+
+static int firmware_stream_open(struct mg_http_message *hm, size_t size,
+                                void **ctx) {
+    (void) hm;
+    (void) ctx;
+
+    if (s_fw_size == 0 || size != s_fw_size) {
+        MG_ERROR(("Firmware stream: size %lu, expected %lu",
+                  (unsigned long) size, (unsigned long) s_fw_size));
+        return ERR_INVALID_PARAM;
+    }
+    fw_reset();
+    return 0;
+}
+
+static long firmware_stream_write(void *ctx, size_t offset,
+                                  const void *buf, size_t len) {
+    (void) ctx;
+
+    if (offset + len < s_fw_size) {
+        len = MG_ROUND_DOWN(len, SIM_FLASH_PAGE_SIZE);
+    }
+    fw_write(offset, buf, len);
+    return (long) len;
+}
+
+static int firmware_stream_close(void *ctx, bool complete) {
+    (void) ctx;
+
+    MG_INFO(("Firmware stream %s: name=%s written=%lu/%lu",
+             complete ? "done" : "aborted", s_fw_name,
+             (unsigned long) s_fw_written, (unsigned long) s_fw_size));
+    return complete ? fw_verify() : ERR_OTA_WRITE_FAILED;
+}
+
 // -----------------------------------------------------------------------------
 // Debug API Handlers
 // -----------------------------------------------------------------------------
@@ -441,8 +642,16 @@ static void handle_debug_get(struct mg_connection *c,
     (void) u;
 
     // Build JSON response with all debug info
-    char json[2048];
-    mg_snprintf(json, sizeof(json),
+    char *json;
+    struct sim_status st;
+    const struct sim_tcp_conn *tc = st.tcp_custom, *tm = st.tcp_mbtcp;
+    struct web_udpfwd_stats fw;
+    struct web_log_stats ls;
+
+    web_snapshot_read(&s_status, &st);
+    web_udpfwd_get_stats(&fw);
+    web_log_get_stats(&ls);
+    json = mg_mprintf(
         "{\"tcp_connections\":{"
         "\"custom\":["
         "{\"id\":1,\"connected\":%s,\"ip\":%m,\"port\":%d},"
@@ -464,14 +673,20 @@ static void handle_debug_get(struct mg_connection *c,
         "\"mbtcp2_rx\":%s,\"mbtcp2_tx\":%s,"
         "\"mbtcp3_rx\":%s,\"mbtcp3_tx\":%s,"
         "\"udp_log\":%s},"
-        "\"op_log\":{\"io\":%s,\"mbtcp\":%s,\"op\":%s,\"tool\":%s,\"screen\":%s}}",
+        "\"udp_forward_stats\":{\"frames\":%llu,\"datagrams\":%llu,"
+        "\"sends\":%llu,\"dropped\":%llu,\"truncated\":%llu,"
+        "\"send_errors\":%llu},"
+        "\"op_log\":{\"io\":%s,\"mbtcp\":%s,\"op\":%s,\"tool\":%s,\"screen\":%s},"
+        "\"log_stats\":{\"records\":%llu,\"truncated\":%llu,"
+        "\"flushes\":%llu,\"bytes\":%llu},"
+        "\"tcp_stats\":%M}",
         // TCP custom
-        s_tcp_custom[0].connected ? "true" : "false", MG_ESC(s_tcp_custom[0].ip), s_tcp_custom[0].port,
-        s_tcp_custom[1].connected ? "true" : "false", MG_ESC(s_tcp_custom[1].ip), s_tcp_custom[1].port,
+        tc[0].connected ? "true" : "false", MG_ESC(tc[0].ip), tc[0].port,
+        tc[1].connected ? "true" : "false", MG_ESC(tc[1].ip), tc[1].port,
         // TCP mbtcp
-        s_tcp_mbtcp[0].connected ? "true" : "false", MG_ESC(s_tcp_mbtcp[0].ip), s_tcp_mbtcp[0].port,
-        s_tcp_mbtcp[1].connected ? "true" : "false", MG_ESC(s_tcp_mbtcp[1].ip), s_tcp_mbtcp[1].port,
-        s_tcp_mbtcp[2].connected ? "true" : "false", MG_ESC(s_tcp_mbtcp[2].ip), s_tcp_mbtcp[2].port,
+        tm[0].connected ? "true" : "false", MG_ESC(tm[0].ip), tm[0].port,
+        tm[1].connected ? "true" : "false", MG_ESC(tm[1].ip), tm[1].port,
+        tm[2].connected ? "true" : "false", MG_ESC(tm[2].ip), tm[2].port,
         // UDP target
         MG_ESC(s_udp_target_ip),
         // CLI
@@ -485,12 +700,22 @@ static void handle_debug_get(struct mg_connection *c,
         s_udp_forward.mbtcp2_rx ? "true" : "false", s_udp_forward.mbtcp2_tx ? "true" : "false",
         s_udp_forward.mbtcp3_rx ? "true" : "false", s_udp_forward.mbtcp3_tx ? "true" : "false",
         s_udp_forward.udp_log ? "true" : "false",
+        // UDP forward stats
+        (unsigned long long) fw.frames, (unsigned long long) fw.datagrams,
+        (unsigned long long) fw.sends, (unsigned long long) fw.dropped,
+        (unsigned long long) fw.truncated, (unsigned long long) fw.send_errors,
         // Op log
         s_op_log.io ? "true" : "false", s_op_log.mbtcp ? "true" : "false",
         s_op_log.op ? "true" : "false", s_op_log.tool ? "true" : "false",
-        s_op_log.screen ? "true" : "false");
+        s_op_log.screen ? "true" : "false",
+        // Server log output
+        (unsigned long long) ls.records, (unsigned long long) ls.truncated,
+        (unsigned long long) ls.flushes, (unsigned long long) ls.bytes,
+        // TCP connections on this event loop
+        web_tcpstats_print, c->mgr);
 
     api_reply_ok(c, json);
+    mg_free(json);
 }
 
 static void handle_debug_set(struct mg_connection *c,
@@ -503,6 +728,9 @@ static void handle_debug_set(struct mg_connection *c,
     if (ip) {
         mg_snprintf(s_udp_target_ip, sizeof(s_udp_target_ip), "%s", ip);
         mg_free(ip);
+        if (!web_udpfwd_set_target(s_udp_target_ip)) {
+            MG_ERROR(("UDP forward paused, bad target %s", s_udp_target_ip));
+        }
     }
 
     // Parse CLI flags
@@ -560,6 +788,7 @@ static void handle_debug_set(struct mg_connection *c,
 
     found = mg_json_get_bool(hm->body, "$.udp_forward.udp_log", &val);
     if (found) s_udp_forward.udp_log = val;
+    web_udpfwd_set_mask(udp_forward_mask());
 
     // Parse operation log flags
     found = mg_json_get_bool(hm->body, "$.op_log.io", &val);
@@ -590,6 +819,7 @@ static void handle_debug_save(struct mg_connection *c,
 
     // Simulator: just log and return success
     MG_INFO(("Debug settings saved to storage (simulated)"));
+    sim_log(MG_LL_INFO, SIM_LOG_WEB, "Debug settings saved");
     api_reply_ok(c, NULL);
 }
 
@@ -600,67 +830,263 @@ static void handle_debug_save(struct mg_connection *c,
 // Simulate logs directory path (relative to project root for VSCode debugging)
 #define SIM_LOGS_DIR "webserver/simulate/Logs"
 
-// Context structure for directory listing callback
-struct log_list_ctx {
-    char *p;
-    size_t remain;
-    int count;
+#ifndef LOG_LIST_LIMIT
+#define LOG_LIST_LIMIT 50  // Default and maximum entries per /api/log page
+#endif
+
+// Cached index of SIM_LOGS_DIR, sorted by name. Rebuilt only when the
+// directory mtime changes, so a listing costs one st() instead of a full
+// directory walk. Device glue that rotates or appends log files should clear
+// s_log_dir.valid there instead of relying on the mtime (appends do not
+// change a directory's mtime, so cached sizes would lag behind).
+struct log_file {
+    char name[64];
+    size_t size;
+    time_t mtime;
 };
 
+static struct {
+    struct log_file *files;
+    size_t count, cap;
+    time_t dir_mtime;
+    bool valid;
+} s_log_dir;
+
 // Callback for mg_fs_posix.ls()
-static void log_list_cb(const char *name, void *data) {
-    struct log_list_ctx *ctx = (struct log_list_ctx *)data;
+static void log_dir_add(const char *name, void *data) {
+    struct log_file *f;
+    char path[256];
+    size_t fsize = 0;
+    time_t mtime = 0;
+    (void) data;
 
-    // Skip . and ..
-    if (name[0] == '.') return;
+    // Skip . and .., and names the cache entry cannot hold
+    if (name[0] == '.' || strlen(name) >= sizeof(f->name)) return;
 
-    // Get file size using Mongoose fs API
-    char path[256];
     mg_snprintf(path, sizeof(path), "%s/%s", SIM_LOGS_DIR, name);
-    size_t fsize = 0;
+    if (!(mg_fs_posix.st(path, &fsize, &mtime) & MG_FS_READ)) return;
+
+    if (s_log_dir.count == s_log_dir.cap) {
+        size_t cap = s_log_dir.cap ? s_log_dir.cap * 2 : 16;
+        struct log_file *p = (struct log_file *) mg_calloc(cap, sizeof(*p));
+        if (p == NULL) return;
+        if (s_log_dir.count > 0) {
+            memcpy(p, s_log_dir.files, s_log_dir.count * sizeof(*p));
+        }
+        mg_free(s_log_dir.files);
+        s_log_dir.files = p;
+        s_log_dir.cap = cap;
+    }
+    f = &s_log_dir.files[s_log_dir.count++];
+    mg_snprintf(f->name, sizeof(f->name), "%s", name);
+    f->size = fsize;
+    f->mtime = mtime;
+}
+
+static int log_file_cmp(const void *a, const void *b) {
+    return strcmp(((const struct log_file *) a)->name,
+                  ((const struct log_file *) b)->name);
+}
+
+static void log_dir_refresh(void) {
     time_t mtime = 0;
-    int flags = mg_fs_posix.st(path, &fsize, &mtime);
+    mg_fs_posix.st(SIM_LOGS_DIR, NULL, &mtime);
+    if (s_log_dir.valid && mtime == s_log_dir.dir_mtime) return;
+
+    s_log_dir.count = 0;
+    mg_fs_posix.ls(SIM_LOGS_DIR, log_dir_add, NULL);
+    if (s_log_dir.count > 1) {
+        qsort(s_log_dir.files, s_log_dir.count, sizeof(struct log_file),
+              log_file_cmp);
+    }
+    s_log_dir.dir_mtime = mtime;
+    // mtime has one second resolution: a change later within the same
+    // second would go unnoticed, so only trust the scan once it is older
+    s_log_dir.valid = mtime < time(NULL);
+}
+
+// Index of the first cached entry whose name sorts after cursor
+static size_t log_dir_seek(const char *cursor) {
+    size_t lo = 0, hi = s_log_dir.count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (strcmp(s_log_dir.files[mid].name, cursor) <= 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Memory logs: boot.log is a static buffer, recent.log lives in the store
+static size_t memory_log_size(const char *name) {
+    if (strcmp(name, "recent.log") == 0) return web_logstore_size(&s_log_store);
+    return strlen(s_boot_log_content);
+}
+
+// Memory logs are exposed as a read-only mg_fs, so mg_http_serve_file()
+// handles Range, ETag and streaming for them just like for file logs
+struct memlog_fd {
+    const char *name;
+    size_t start;  // s_log_store.base at open time
+    size_t pos;
+};
+
+static const char *memlog_find(const char *path) {
+    for (int i = 0; s_memory_logs[i] != NULL; i++) {
+        if (strcmp(path, s_memory_logs[i]) == 0) return s_memory_logs[i];
+    }
+    return NULL;
+}
 
-    // Skip if not a file
-    if (!(flags & MG_FS_READ)) return;
+static int memlog_st(const char *path, size_t *size, time_t *mtime) {
+    const char *name = memlog_find(path);
+    if (name == NULL) return 0;
+    web_lock();
+    if (size != NULL) *size = memory_log_size(name);
+    if (mtime != NULL) {
+        *mtime = strcmp(name, "recent.log") == 0 ? s_recent_mtime : s_boot_time;
+    }
+    web_unlock();
+    return MG_FS_READ;
+}
+
+static void memlog_ls(const char *path, void (*fn)(const char *, void *),
+                      void *arg) {
+    (void) path;
+    for (int i = 0; s_memory_logs[i] != NULL; i++) fn(s_memory_logs[i], arg);
+}
 
-    int n = mg_snprintf(ctx->p, ctx->remain, "%s{\"name\":%m,\"size\":%lu,\"type\":\"file\"}",
-                        ctx->count > 0 ? "," : "",
-                        MG_ESC(name),
-                        (unsigned long)fsize);
-    ctx->p += n;
-    ctx->remain -= (size_t)n;
-    ctx->count++;
+static void *memlog_op(const char *path, int flags) {
+    const char *name = memlog_find(path);
+    struct memlog_fd *fd;
+    if (name == NULL || flags != MG_FS_READ) return NULL;
+    fd = (struct memlog_fd *) mg_calloc(1, sizeof(*fd));
+    if (fd != NULL) {
+        fd->name = name;
+        web_lock();
+        fd->start = s_log_store.base;
+        web_unlock();
+    }
+    return fd;
 }
 
+static void memlog_cl(void *fd) {
+    mg_free(fd);
+}
+
+static size_t memlog_rd(void *fd, void *buf, size_t len) {
+    struct memlog_fd *f = (struct memlog_fd *) fd;
+    size_t n = 0, total;
+
+    if (strcmp(f->name, "recent.log") == 0) {
+        // Keep offsets fixed while the store rotates; rotated-out data is gone.
+        // Streaming runs outside the event handler, so take the lock here.
+        size_t abs = f->start + f->pos;
+        web_lock();
+        if (abs >= s_log_store.base) {
+            n = web_logstore_read(&s_log_store, abs - s_log_store.base, buf, len);
+        }
+        web_unlock();
+    } else {
+        total = strlen(s_boot_log_content);
+        n = f->pos < total ? total - f->pos : 0;
+        if (n > len) n = len;
+        memcpy(buf, s_boot_log_content + f->pos, n);
+    }
+    f->pos += n;
+    return n;
+}
+
+static size_t memlog_wr(void *fd, const void *buf, size_t len) {
+    (void) fd, (void) buf, (void) len;
+    return 0;
+}
+
+static size_t memlog_sk(void *fd, size_t offset) {
+    ((struct memlog_fd *) fd)->pos = offset;
+    return offset;
+}
+
+static bool memlog_mv(const char *from, const char *to) {
+    (void) from, (void) to;
+    return false;
+}
+
+static bool memlog_rm(const char *path) {
+    (void) path;
+    return false;
+}
+
+static bool memlog_mkd(const char *path) {
+    (void) path;
+    return false;
+}
+
+static struct mg_fs s_memlog_fs = {
+    memlog_st, memlog_ls, memlog_op, memlog_cl, memlog_rd,
+    memlog_wr, memlog_sk, memlog_mv, memlog_rm, memlog_mkd
+};
+
+// GET /api/log?cursor=<name>&limit=N
+// File logs are paged by name; memory logs come first, on the first page
 static void handle_log_list(struct mg_connection *c,
                             struct mg_http_message *hm,
                             struct user *u) {
-    (void) hm;
+    struct mg_iobuf io = {NULL, 0, 0, 256};
+    char cursor[64] = "", buf[16];
+    size_t i, end, limit = LOG_LIST_LIMIT;
+    int count = 0;
     (void) u;
 
-    char json[2048];
-    struct log_list_ctx ctx = {json, sizeof(json), 0};
-    int n;
-
-    n = mg_snprintf(ctx.p, ctx.remain, "{\"logs\":[");
-    ctx.p += n; ctx.remain -= (size_t)n;
+    mg_http_get_var(&hm->query, "cursor", cursor, sizeof(cursor));
+    if (mg_http_get_var(&hm->query, "limit", buf, sizeof(buf)) > 0) {
+        limit = (size_t) atoi(buf);
+        if (limit == 0 || limit > LOG_LIST_LIMIT) limit = LOG_LIST_LIMIT;
+    }
 
-    // 1. List file logs from simulate/Logs directory using Mongoose fs API
-    mg_fs_posix.ls(SIM_LOGS_DIR, log_list_cb, &ctx);
+    log_dir_refresh();
+    i = cursor[0] == '\0' ? 0 : log_dir_seek(cursor);
+    end = s_log_dir.count - i > limit ? i + limit : s_log_dir.count;
+
+    mg_xprintf(mg_pfn_iobuf, &io, "{\"logs\":[");
+    if (cursor[0] == '\0') {
+        for (int k = 0; s_memory_logs[k] != NULL; k++) {
+            mg_xprintf(mg_pfn_iobuf, &io,
+                       "%s{\"name\":%m,\"size\":%lu,\"type\":\"memory\"}",
+                       count++ > 0 ? "," : "", MG_ESC(s_memory_logs[k]),
+                       (unsigned long) memory_log_size(s_memory_logs[k]));
+        }
+    }
+    for (; i < end; i++) {
+        mg_xprintf(mg_pfn_iobuf, &io,
+                   "%s{\"name\":%m,\"size\":%lu,\"type\":\"file\"}",
+                   count++ > 0 ? "," : "", MG_ESC(s_log_dir.files[i].name),
+                   (unsigned long) s_log_dir.files[i].size);
+    }
+    mg_xprintf(mg_pfn_iobuf, &io, "]");
+    if (end < s_log_dir.count) {
+        mg_xprintf(mg_pfn_iobuf, &io, ",\"next\":%m",
+                   MG_ESC(s_log_dir.files[end - 1].name));
+    }
+    mg_xprintf(mg_pfn_iobuf, &io, "}");
 
-    // 2. Add memory logs
-    for (int i = 0; s_memory_logs[i].name != NULL; i++) {
-        n = mg_snprintf(ctx.p, ctx.remain, "%s{\"name\":%m,\"size\":%d,\"type\":%m}",
-                        ctx.count > 0 ? "," : "",
-                        MG_ESC(s_memory_logs[i].name), s_memory_logs[i].size,
-                        MG_ESC(s_memory_logs[i].type));
-        ctx.p += n; ctx.remain -= (size_t)n;
-        ctx.count++;
+    if (io.buf == NULL) {
+        HTTP_REPLY_500(c);
+    } else {
+        api_reply_ok(c, (const char *) io.buf);
     }
+    mg_iobuf_free(&io);
+}
 
-    mg_snprintf(ctx.p, ctx.remain, "]}");
-    api_reply_ok(c, json);
+// Already-compressed formats are sent as they are
+static bool log_compressible(const char *name) {
+    static const char *packed[] = {"#.gz", "#.zip", "#.png", "#.jpg", NULL};
+    for (int i = 0; packed[i] != NULL; i++) {
+        if (mg_match(mg_str(name), mg_str(packed[i]), NULL)) return false;
+    }
+    return true;
 }
 
 static void handle_log_download(struct mg_connection *c,
@@ -668,52 +1094,21 @@ static void handle_log_download(struct mg_connection *c,
                                 struct user *u) {
     (void) u;
 
-    char name[64], offset_str[20], size_str[20];
-    int offset = 0, size = 1024;
+    char name[64], headers[256];
+    struct mg_http_serve_opts opts = {0};
 
     mg_http_get_var(&hm->query, "name", name, sizeof(name));
-    mg_http_get_var(&hm->query, "offset", offset_str, sizeof(offset_str));
-    mg_http_get_var(&hm->query, "size", size_str, sizeof(size_str));
-
-    if (offset_str[0]) offset = (int) strtol(offset_str, NULL, 10);
-    if (size_str[0]) size = (int) strtol(size_str, NULL, 10);
-    if (size > 1024) size = 1024;  // Max chunk size
-
-    // Check if it's a memory log
-    const char *content = NULL;
-    for (int i = 0; s_memory_logs[i].name != NULL; i++) {
-        if (strcmp(s_memory_logs[i].name, name) == 0) {
-            // Memory log found
-            if (strcmp(name, "boot.log") == 0) {
-                content = s_boot_log_content;
-            } else if (strcmp(name, "recent.log") == 0) {
-                content = s_recent_log_content;
-            }
-            break;
-        }
-    }
 
-    if (content != NULL) {
-        // Memory log: return binary data directly
-        int content_len = (int) strlen(content);
-        if (offset >= content_len) {
-            offset = content_len;
-            size = 0;
-        } else if (offset + size > content_len) {
-            size = content_len - offset;
-        }
+    // Build Content-Disposition header with filename
+    mg_snprintf(headers, sizeof(headers),
+                "Content-Disposition: attachment; filename=\"%s\"\r\n", name);
+    opts.extra_headers = headers;
 
-        // Send HTTP headers first
-        mg_printf(c, "HTTP/1.1 200 OK\r\n"
-                     "Content-Type: application/octet-stream\r\n"
-                     "Content-Range: bytes %d-%d/%d\r\n"
-                     "Content-Length: %d\r\n"
-                     "\r\n",
-                 offset, offset + size - 1, content_len, size);
-
-        // Send binary data directly
-        mg_send(c, content + offset, (size_t) size);
-        c->is_resp = 0;
+    // Memory log: Range / ETag / streaming handled by mg_http_serve_file,
+    // gzip by http_serve_gzip when the client accepts it
+    if (memlog_find(name) != NULL) {
+        opts.fs = &s_memlog_fs;
+        http_serve_gzip(c, hm, name, &opts);
         return;
     }
 
@@ -737,14 +1132,11 @@ static void handle_log_download(struct mg_connection *c,
         return;
     }
 
-    // Build Content-Disposition header with filename
-    char headers[256];
-    mg_snprintf(headers, sizeof(headers),
-                "Content-Disposition: attachment; filename=\"%s\"\r\n", name);
-
-    struct mg_http_serve_opts opts = {0};
-    opts.extra_headers = headers;
-    mg_http_serve_file(c, hm, path, &opts);
+    if (log_compressible(name)) {
+        http_serve_gzip(c, hm, path, &opts);
+    } else {
+        mg_http_serve_file(c, hm, path, &opts);
+    }
 }
 
 // -----------------------------------------------------------------------------
@@ -758,6 +1150,7 @@ static void handle_reboot(struct mg_connection *c,
 
     api_reply_ok(c, NULL);
     MG_INFO(("Reboot requested (simulator mode - no action)"));
+    sim_log(MG_LL_INFO, SIM_LOG_SYSTEM, "Reboot requested");
 }
 
 // -----------------------------------------------------------------------------
@@ -794,11 +1187,26 @@ struct api_handler s_api_handlers[] = {
     {NULL, 0, NULL}
 };
 
+// -----------------------------------------------------------------------------
+// Streaming Upload Registry
+// -----------------------------------------------------------------------------
+struct upload_handler s_upload_handlers[] = {
+    {"/api/firmware/stream", PERM_ADMIN,
+     firmware_stream_open, firmware_stream_write, firmware_stream_close},
+
+    // End marker
+    {NULL, 0, NULL, NULL, NULL}
+};
+
 // -----------------------------------------------------------------------------
 // WebSocket Status Push Timer
 // -----------------------------------------------------------------------------
 static void timer_status_push(void *arg) {
     struct mg_mgr *mgr = (struct mg_mgr *) arg;
+    struct sim_status st;
+
+    web_snapshot_read(&s_status, &st);
+    web_lock();
 
     // Get current UTC time
     time_t now = time(NULL);
@@ -811,12 +1219,56 @@ static void timer_status_push(void *arg) {
         "\"sram_used\":%d,\"sram_max\":%d,"
         "\"sdram_used\":%d,\"sdram_max\":%d,"
         "\"timestamp\":%lu,\"tz_offset\":%d}}",
-        s_tool_state, s_tool_change ? "true" : "false",
-        s_sram_used, s_sram_max,
-        s_sdram_used, s_sdram_max,
+        st.tool_state, st.tool_changes != s_tool_seen ? "true" : "false",
+        st.sram_used, st.sram_max,
+        st.sdram_used, st.sdram_max,
         (unsigned long) now, s_tz_offset);
 
     ws_broadcast(mgr, json);
+    web_unlock();
+}
+
+// -----------------------------------------------------------------------------
+// Simulated Operation Log Timer
+// -----------------------------------------------------------------------------
+// Produce the records a real device logs for the categories enabled on the
+// Debug page, so the live log tail and the UDP forward have something to show
+static void sim_traffic(const char *channel, int rx_ch, bool rx, bool tx) {
+    static const uint8_t req[8] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x02, 0xc4, 0x0b};
+    static const uint8_t rsp[12] = {0x01, 0x03, 0x04, 0x00, 0x01, 0x00, 0x02,
+                                    0x2a, 0x32, 0x00, 0x00, 0x00};
+    if (rx) {
+        sim_log(MG_LL_DEBUG, SIM_LOG_UDP, "%s rx: 12 bytes", channel);
+        web_udpfwd_capture(rx_ch, rsp, sizeof(rsp));
+    }
+    if (tx) {
+        sim_log(MG_LL_DEBUG, SIM_LOG_UDP, "%s tx: 8 bytes", channel);
+        web_udpfwd_capture(rx_ch + 1, req, sizeof(req));
+    }
+}
+
+static void timer_op_log(void *arg) {
+    static unsigned tick = 0;
+    struct sim_status st;
+    (void) arg;
+
+    web_snapshot_read(&s_status, &st);
+    web_lock();
+    tick++;
+    if (s_op_log.io) sim_log(MG_LL_INFO, SIM_LOG_IO, "Input changed: 0x%02x", tick & 0xff);
+    if (s_op_log.mbtcp) sim_log(MG_LL_INFO, SIM_LOG_MBTCP, "Write register 40001 = %u", tick);
+    if (s_op_log.op) sim_log(MG_LL_INFO, SIM_LOG_OP, "Program %u selected", tick % 8);
+    if (s_op_log.tool) sim_log(MG_LL_INFO, SIM_LOG_TOOL, "Tool state %d", st.tool_state);
+    if (s_op_log.screen) sim_log(MG_LL_INFO, SIM_LOG_SCREEN, "Page %u shown", tick % 4);
+
+    sim_traffic("tool", WEB_UDPFWD_TOOL_RX, s_udp_forward.tool_rx, s_udp_forward.tool_tx);
+    sim_traffic("screen", WEB_UDPFWD_SCREEN_RX, s_udp_forward.screen_rx, s_udp_forward.screen_tx);
+    sim_traffic("op1", WEB_UDPFWD_OP1_RX, s_udp_forward.op1_rx, s_udp_forward.op1_tx);
+    sim_traffic("op2", WEB_UDPFWD_OP2_RX, s_udp_forward.op2_rx, s_udp_forward.op2_tx);
+    sim_traffic("mbtcp1", WEB_UDPFWD_MBTCP1_RX, s_udp_forward.mbtcp1_rx, s_udp_forward.mbtcp1_tx);
+    sim_traffic("mbtcp2", WEB_UDPFWD_MBTCP2_RX, s_udp_forward.mbtcp2_rx, s_udp_forward.mbtcp2_tx);
+    sim_traffic("mbtcp3", WEB_UDPFWD_MBTCP3_RX, s_udp_forward.mbtcp3_rx, s_udp_forward.mbtcp3_tx);
+    web_unlock();
 }
 
 // -----------------------------------------------------------------------------
@@ -839,14 +1291,36 @@ void web_init(struct mg_mgr *mgr) {
     s_mgr = mgr;
 
     web_user_init();
+    s_boot_time = time(NULL);
+
+    // Publish the initial device status; device tasks keep it current with
+    // web_snapshot_write() from their own threads
+    if (!web_snapshot_init(&s_status, sizeof(struct sim_status))) {
+        MG_ERROR(("Cannot allocate device status"));
+        return;
+    }
+    web_snapshot_write(&s_status, &s_status_init);
+
+    // Open the persistent device log behind recent.log
+    s_log_store_ok = web_logstore_open(&s_log_store, &mg_fs_posix, SIM_STORE_DIR);
+    if (!s_log_store_ok) MG_ERROR(("Cannot open log store %s", SIM_STORE_DIR));
+    sim_log(MG_LL_INFO, SIM_LOG_SYSTEM, "Web server started");
+
+    // Debug traffic mirror, batched into datagrams on this event loop
+    if (!web_udpfwd_init(mgr)) MG_ERROR(("Cannot start UDP forward"));
+    web_udpfwd_set_target(s_udp_target_ip);
+    web_udpfwd_set_mask(udp_forward_mask());
 
     // Start HTTP listener
-    mg_http_listen(mgr, HTTP_URL, ev_handler, NULL);
+    web_listen(mgr, HTTP_URL, ev_handler, NULL);
     MG_INFO(("HTTP listener started on %s", HTTP_URL));
 
     // Add status push timer (every 3 seconds)
     mg_timer_add(mgr, 3000, MG_TIMER_REPEAT, timer_status_push, mgr);
     MG_INFO(("Simulator mode: status push timer started"));
+
+    // Simulated operation log records (every second)
+    mg_timer_add(mgr, 1000, MG_TIMER_REPEAT, timer_op_log, NULL);
 }
 
 #endif  // !WEBSERVER_USER
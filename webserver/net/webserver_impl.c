@@ -3,6 +3,9 @@
 
 #include "webserver_impl.h"
 #include "webserver_glue.h"
+#include "webserver_deflate.h"
+#include "webserver_reactor.h"
+#include "webserver_tcpstats.h"
 
 #include <string.h>
 
@@ -36,14 +39,511 @@ void api_reply_fail(struct mg_connection *c, int code, const char *message) {
 }
 
 // -----------------------------------------------------------------------------
-// WebSocket Broadcast
+// WebSocket Connection State (stored in c->data)
 // -----------------------------------------------------------------------------
+#define WS_RSV1 0x40  // Frame header bit marking a compressed message
+
+struct ws_state {
+    struct web_deflate *deflate;  // permessage-deflate encoder, NULL if off
+    uint32_t log_seq;             // Next log record to send
+    uint32_t log_off;             // Ring offset of that record
+    uint32_t log_dropped;         // Records lost since the last log frame
+    uint32_t log_modules;         // Subscribed modules, bit per module id
+    uint32_t stats_due;           // mg_millis() of the next TCP stats frame
+    uint8_t log_level;            // Highest level sent, MG_LL_NONE = off
+    bool deflate_no_takeover;     // Client asked for server_no_context_takeover
+    bool stats;                   // Subscribed to TCP stats
+};
+
+_Static_assert(sizeof(struct ws_state) <= WEB_TCPMETER_ROOM,
+               "ws_state overlaps the connection meter");
+
+// Trim spaces around extension tokens
+static struct mg_str ws_trim(struct mg_str s) {
+    while (s.len > 0 && s.buf[0] == ' ') s.buf++, s.len--;
+    while (s.len > 0 && s.buf[s.len - 1] == ' ') s.len--;
+    return s;
+}
+
+// Pick the first acceptable permessage-deflate offer (RFC 7692 section 7).
+// Returns the window bits to use, or 0 to decline compression.
+static int ws_deflate_offer(struct mg_str ext, bool *no_takeover) {
+    int max_bits = web_deflate_bits_for(WEBSERVER_WS_DEFLATE_MEM);
+    struct mg_str offer, name, params, param, key, val;
+
+    while (max_bits > 0 && mg_span(ext, &offer, &ext, ',')) {
+        int bits = max_bits;
+        bool ok = true;
+
+        mg_span(offer, &name, &params, ';');
+        if (mg_strcmp(ws_trim(name), mg_str("permessage-deflate")) != 0) {
+            continue;
+        }
+        *no_takeover = false;
+        while (ok && mg_span(params, &param, &params, ';')) {
+            mg_span(param, &key, &val, '=');
+            key = ws_trim(key);
+            val = ws_trim(val);
+            if (mg_strcmp(key, mg_str("server_no_context_takeover")) == 0) {
+                *no_takeover = true;
+            } else if (mg_strcmp(key, mg_str("server_max_window_bits")) == 0) {
+                uint8_t n = 0;
+                ok = mg_str_to_num(val, 10, &n, sizeof(n)) &&
+                     n >= WEB_DEFLATE_MIN_BITS && n <= WEB_DEFLATE_MAX_BITS;
+                if (ok && n < bits) bits = n;
+            } else if (mg_strcmp(key, mg_str("client_no_context_takeover")) != 0 &&
+                       mg_strcmp(key, mg_str("client_max_window_bits")) != 0) {
+                ok = false;  // Unknown parameter: decline this offer
+            }
+        }
+        if (ok) return bits;
+    }
+    return 0;
+}
+
+static void ws_log_subscribe(struct ws_state *ws, struct mg_http_message *hm);
+static void ws_log_unsubscribe(struct mg_connection *c);
+static void ws_log_flush(struct mg_connection *c);
+static void ws_stats_flush(struct mg_connection *c);
+
+static void ws_upgrade(struct mg_connection *c, struct mg_http_message *hm) {
+    struct ws_state *ws = (struct ws_state *) c->data;
+    struct mg_str *ext = mg_http_get_header(hm, "Sec-WebSocket-Extensions");
+    bool no_takeover = false;
+    int bits = ext == NULL ? 0 : ws_deflate_offer(*ext, &no_takeover);
+
+    ws_log_subscribe(ws, hm);
+    ws->stats = mg_http_var(hm->query, mg_str("tcpstats")).len > 0;
+    ws->stats_due = (uint32_t) mg_millis();
+
+    if (bits > 0) {
+        ws->deflate = (struct web_deflate *) mg_calloc(1, sizeof(*ws->deflate));
+        if (ws->deflate != NULL && !web_deflate_init(ws->deflate, bits)) {
+            mg_free(ws->deflate);
+            ws->deflate = NULL;
+        }
+    }
+
+    if (ws->deflate == NULL) {
+        mg_ws_upgrade(c, hm, NULL);
+    } else {
+        ws->deflate_no_takeover = no_takeover;
+        mg_ws_upgrade(c, hm,
+                      "Sec-WebSocket-Extensions: permessage-deflate; "
+                      "server_max_window_bits=%d%s\r\n",
+                      bits, no_takeover ? "; server_no_context_takeover" : "");
+    }
+}
+
+static void ws_close(struct mg_connection *c) {
+    struct ws_state *ws = (struct ws_state *) c->data;
+    ws_log_unsubscribe(c);
+    if (ws->deflate != NULL) {
+        MG_DEBUG(("%lu WS deflate: %llu -> %llu bytes", c->id,
+                  ws->deflate->in_bytes, ws->deflate->out_bytes));
+        web_deflate_free(ws->deflate);
+        mg_free(ws->deflate);
+        ws->deflate = NULL;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// WebSocket Send / Broadcast
+// -----------------------------------------------------------------------------
+void ws_send_text(struct mg_connection *c, const char *buf, size_t len) {
+    struct ws_state *ws = (struct ws_state *) c->data;
+
+    if (ws->deflate == NULL) {
+        mg_ws_send(c, buf, len, WEBSOCKET_OP_TEXT);
+        return;
+    }
+
+    // Compress straight into c->send, drop the trailing 00 00 ff ff
+    // (RFC 7692 section 7.2.1), then prepend the frame header in place
+    size_t start = c->send.len;
+    if (ws->deflate_no_takeover) web_deflate_reset(ws->deflate);
+    if (!web_deflate_sync(ws->deflate, buf, len, &c->send)) {
+        // Peer's inflate state can no longer follow ours
+        c->send.len = start;
+        mg_error(c, "WS deflate OOM");
+        return;
+    }
+    c->send.len -= 4;
+    mg_ws_wrap(c, c->send.len - start, WEBSOCKET_OP_TEXT | WS_RSV1);
+}
+
 void ws_broadcast(struct mg_mgr *mgr, const char *json) {
+    size_t len = strlen(json);
+    web_reactors_broadcast(mgr, json);
     for (struct mg_connection *c = mgr->conns; c != NULL; c = c->next) {
         if (c->is_websocket) {
-            mg_ws_send(c, json, strlen(json), WEBSOCKET_OP_TEXT);
+            ws_send_text(c, json, len);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// WebSocket Log Tail
+// -----------------------------------------------------------------------------
+// Published records are kept in a ring shared by all subscribers, each of
+// which remembers how far it has read. On every poll a subscriber gets at
+// most one frame with the new records that pass its filter. A subscriber
+// whose send buffer is over WEBSERVER_WS_LOG_BACKLOG gets nothing; if the
+// ring overwrites records it has not read yet, they are counted in the
+// "dropped" field of its next frame.
+//
+// Ring record: u32 seq, u8 level, u8 module, u16 len, text[len]
+#define WS_LOG_HDR_SIZE 8
+
+static struct {
+    uint8_t buf[WEBSERVER_WS_LOG_RING];
+    uint32_t head, tail;          // Free-running offsets, buf index = off % size
+    uint32_t head_seq, tail_seq;  // Sequence numbers at head and tail
+    int subscribers;
+} s_ws_log;
+
+static void ws_log_put(uint32_t off, const void *buf, size_t len) {
+    const uint8_t *p = (const uint8_t *) buf;
+    for (size_t i = 0; i < len; i++) {
+        s_ws_log.buf[(off + i) % WEBSERVER_WS_LOG_RING] = p[i];
+    }
+}
+
+static void ws_log_get(uint32_t off, void *buf, size_t len) {
+    uint8_t *p = (uint8_t *) buf;
+    for (size_t i = 0; i < len; i++) {
+        p[i] = s_ws_log.buf[(off + i) % WEBSERVER_WS_LOG_RING];
+    }
+}
+
+void ws_log_publish(int level, int module, const char *text, size_t len) {
+    uint8_t hdr[WS_LOG_HDR_SIZE];
+    uint32_t seq = s_ws_log.head_seq;
+
+    if (s_ws_log.subscribers == 0) return;
+    if (len > WEBSERVER_WS_LOG_TEXT_MAX) len = WEBSERVER_WS_LOG_TEXT_MAX;
+
+    // Evict the oldest records until the new one fits
+    while (s_ws_log.head - s_ws_log.tail + WS_LOG_HDR_SIZE + len >
+           WEBSERVER_WS_LOG_RING) {
+        ws_log_get(s_ws_log.tail, hdr, sizeof(hdr));
+        s_ws_log.tail += WS_LOG_HDR_SIZE + (uint32_t) (hdr[6] | (hdr[7] << 8));
+        s_ws_log.tail_seq++;
+    }
+
+    memcpy(hdr, &seq, 4);
+    hdr[4] = (uint8_t) level;
+    hdr[5] = (uint8_t) module;
+    hdr[6] = (uint8_t) len;
+    hdr[7] = (uint8_t) (len >> 8);
+    ws_log_put(s_ws_log.head, hdr, sizeof(hdr));
+    ws_log_put(s_ws_log.head + WS_LOG_HDR_SIZE, text, len);
+    s_ws_log.head += WS_LOG_HDR_SIZE + (uint32_t) len;
+    s_ws_log.head_seq++;
+}
+
+static const char *ws_log_module_name(int module) {
+    extern const char *s_log_modules[];
+    for (int i = 0; s_log_modules[i] != NULL; i++) {
+        if (i == module) return s_log_modules[i];
+    }
+    return "";
+}
+
+// /ws?log=<error|info|debug>&modules=<name,name,...> (all modules if omitted)
+static void ws_log_subscribe(struct ws_state *ws, struct mg_http_message *hm) {
+    extern const char *s_log_modules[];
+    static const char *levels[] = {"none", "error", "info", "debug", "verbose"};
+    char level[16], modules[128];
+    struct mg_str list, name;
+
+    mg_http_get_var(&hm->query, "log", level, sizeof(level));
+    for (int i = MG_LL_ERROR; i <= MG_LL_VERBOSE; i++) {
+        if (strcmp(level, levels[i]) == 0) ws->log_level = (uint8_t) i;
+    }
+    if (ws->log_level == MG_LL_NONE) return;
+
+    if (mg_http_get_var(&hm->query, "modules", modules, sizeof(modules)) > 0) {
+        list = mg_str(modules);
+        while (mg_span(list, &name, &list, ',')) {
+            for (int i = 0; s_log_modules[i] != NULL && i < 32; i++) {
+                if (mg_strcmp(name, mg_str(s_log_modules[i])) == 0) {
+                    ws->log_modules |= 1UL << i;
+                }
+            }
+        }
+    } else {
+        ws->log_modules = 0xffffffffUL;
+    }
+
+    // Only records published from now on are streamed
+    ws->log_seq = s_ws_log.head_seq;
+    ws->log_off = s_ws_log.head;
+    s_ws_log.subscribers++;
+}
+
+static void ws_log_unsubscribe(struct mg_connection *c) {
+    struct ws_state *ws = (struct ws_state *) c->data;
+    if (ws->log_level != MG_LL_NONE) {
+        MG_DEBUG(("%lu WS log: %lu records dropped", c->id,
+                  (unsigned long) ws->log_dropped));
+        ws->log_level = MG_LL_NONE;
+        s_ws_log.subscribers--;
+    }
+}
+
+static void ws_log_flush(struct mg_connection *c) {
+    struct ws_state *ws = (struct ws_state *) c->data;
+    struct mg_iobuf io = {NULL, 0, 0, 512};
+    uint8_t hdr[WS_LOG_HDR_SIZE];
+    char text[WEBSERVER_WS_LOG_TEXT_MAX];
+    int count = 0;
+
+    if (ws->log_level == MG_LL_NONE || ws->log_seq == s_ws_log.head_seq ||
+        c->send.len > WEBSERVER_WS_LOG_BACKLOG) {
+        return;
+    }
+
+    // Fell behind the ring: skip to the oldest record still held
+    if (s_ws_log.head - ws->log_off > s_ws_log.head - s_ws_log.tail) {
+        ws->log_dropped += s_ws_log.tail_seq - ws->log_seq;
+        ws->log_seq = s_ws_log.tail_seq;
+        ws->log_off = s_ws_log.tail;
+    }
+
+    mg_xprintf(mg_pfn_iobuf, &io, "{%m:%m,%m:{%m:[", MG_ESC("type"),
+               MG_ESC("log"), MG_ESC("data"), MG_ESC("records"));
+    while (ws->log_seq != s_ws_log.head_seq && io.len < WEBSERVER_WS_LOG_FRAME) {
+        uint32_t seq;
+        size_t len;
+        ws_log_get(ws->log_off, hdr, sizeof(hdr));
+        memcpy(&seq, hdr, 4);
+        len = (size_t) (hdr[6] | (hdr[7] << 8));
+        if (hdr[4] <= ws->log_level && hdr[5] < 32 &&
+            (ws->log_modules & (1UL << hdr[5]))) {
+            ws_log_get(ws->log_off + WS_LOG_HDR_SIZE, text, len);
+            mg_xprintf(mg_pfn_iobuf, &io, "%s{%m:%lu,%m:%d,%m:%m,%m:%m}",
+                       count++ > 0 ? "," : "", MG_ESC("seq"),
+                       (unsigned long) seq, MG_ESC("level"), hdr[4],
+                       MG_ESC("module"), MG_ESC(ws_log_module_name(hdr[5])),
+                       MG_ESC("text"), mg_print_esc, (int) len, text);
         }
+        ws->log_off += WS_LOG_HDR_SIZE + (uint32_t) len;
+        ws->log_seq++;
+    }
+    mg_xprintf(mg_pfn_iobuf, &io, "],%m:%lu}}", MG_ESC("dropped"),
+               (unsigned long) ws->log_dropped);
+
+    if (count > 0 || ws->log_dropped > 0) {
+        ws_send_text(c, (const char *) io.buf, io.len);
+        ws->log_dropped = 0;
     }
+    mg_iobuf_free(&io);
+}
+
+// -----------------------------------------------------------------------------
+// WebSocket TCP Stats
+// -----------------------------------------------------------------------------
+// /ws?tcpstats=1: every WEBSERVER_WS_TCPSTATS_MS, the stats of the TCP
+// connections on the subscriber's event loop. Skipped while the subscriber
+// is still sending earlier frames.
+static void ws_stats_flush(struct mg_connection *c) {
+    struct ws_state *ws = (struct ws_state *) c->data;
+    uint32_t now = (uint32_t) mg_millis();
+    char *json;
+
+    if (!ws->stats || (int32_t) (now - ws->stats_due) < 0 ||
+        c->send.len > WEBSERVER_WS_LOG_BACKLOG) {
+        return;
+    }
+    ws->stats_due = now + WEBSERVER_WS_TCPSTATS_MS;
+    json = mg_mprintf("{%m:%m,%m:{%m:%M}}", MG_ESC("type"), MG_ESC("tcpstats"),
+                      MG_ESC("data"), MG_ESC("connections"),
+                      web_tcpstats_print, c->mgr);
+    if (json != NULL) {
+        ws_send_text(c, json, strlen(json));
+        mg_free(json);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Gzip File Download
+// -----------------------------------------------------------------------------
+// Like mg_http_serve_file()'s static_cb, the stream takes over c->pfn until
+// the file is sent. Each read is compressed with a sync flush, and reads are
+// gathered into HTTP chunks of about WEBSERVER_GZIP_CHUNK bytes, so RAM use
+// is the deflate window plus one input buffer, and at most
+// WEBSERVER_GZIP_STREAMS run at once. The first chunk leaves together with
+// the headers and the last one with the trailer: a log that compresses well
+// goes out as a few full segments, not one small segment per poll.
+struct gzip_stream {
+    mg_event_handler_t pfn;  // Protocol handler to restore when done
+    void *pfn_data;
+    struct mg_fd *fd;
+    struct web_deflate deflate;
+    uint32_t crc;            // CRC-32 of the uncompressed data
+    uint32_t size;           // Uncompressed size, mod 2^32
+    uint8_t buf[WEBSERVER_GZIP_CHUNK];
+};
+
+static int s_gzip_streams;
+
+// Accept-Encoding lists gzip without q=0
+static bool gzip_accepted(struct mg_http_message *hm) {
+    struct mg_str *ae = mg_http_get_header(hm, "Accept-Encoding");
+    struct mg_str s, tok, name, params, param, key, val;
+    if (ae == NULL) return false;
+    s = *ae;
+    while (mg_span(s, &tok, &s, ',')) {
+        mg_span(tok, &name, &params, ';');
+        if (mg_strcasecmp(ws_trim(name), mg_str("gzip")) != 0) continue;
+        while (mg_span(params, &param, &params, ';')) {
+            mg_span(param, &key, &val, '=');
+            if (mg_strcmp(ws_trim(key), mg_str("q")) != 0) continue;
+            // q=0, q=0.0, ... : explicitly refused
+            val = ws_trim(val);
+            for (size_t i = 0; i < val.len; i++) {
+                if (val.buf[i] != '0' && val.buf[i] != '.') return true;
+            }
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+// Start a chunk with a fixed-width size field, patched by gzip_chunk_end()
+static size_t gzip_chunk_begin(struct mg_connection *c) {
+    size_t start = c->send.len;
+    mg_send(c, "00000000\r\n", 10);
+    return start;
+}
+
+static void gzip_chunk_end(struct mg_connection *c, size_t start) {
+    mg_snprintf((char *) c->send.buf + start, 9, "%08lx",
+                (unsigned long) (c->send.len - start - 10));
+    c->send.buf[start + 8] = '\r';
+    mg_send(c, "\r\n", 2);
+}
+
+static void gzip_stream_done(struct mg_connection *c) {
+    struct gzip_stream *gz = (struct gzip_stream *) c->pfn_data;
+    MG_DEBUG(("%lu gzip: %llu -> %llu bytes", c->id, gz->deflate.in_bytes,
+              gz->deflate.out_bytes));
+    c->pfn = gz->pfn;
+    c->pfn_data = gz->pfn_data;
+    mg_fs_close(gz->fd);
+    web_deflate_free(&gz->deflate);
+    mg_free(gz);
+    s_gzip_streams--;
+}
+
+static void gzip_stream_step(struct mg_connection *c, int ev) {
+    struct gzip_stream *gz = (struct gzip_stream *) c->pfn_data;
+
+    if (ev == MG_EV_CLOSE) {
+        gzip_stream_done(c);
+    } else if (ev == MG_EV_WRITE || ev == MG_EV_POLL) {
+        size_t start, n = 0;
+        uint8_t trailer[8];
+        if (c->send.len >= WEBSERVER_GZIP_CHUNK) return;  // Rate limit
+
+        start = gzip_chunk_begin(c);
+        while (c->send.len - start < WEBSERVER_GZIP_CHUNK &&
+               (n = gz->fd->fs->rd(gz->fd->fd, gz->buf, sizeof(gz->buf))) > 0) {
+            gz->crc = mg_crc32(gz->crc, (const char *) gz->buf, n);
+            gz->size += (uint32_t) n;
+            if (!web_deflate_sync(&gz->deflate, gz->buf, n, &c->send)) {
+                mg_error(c, "gzip OOM");
+                return;
+            }
+        }
+        if (n > 0) {
+            gzip_chunk_end(c, start);
+            return;
+        }
+
+        // End of file: final block and trailer (CRC-32, ISIZE), last chunk
+        if (!web_deflate_finish(&gz->deflate, &c->send)) {
+            mg_error(c, "gzip OOM");
+            return;
+        }
+        for (int i = 0; i < 4; i++) {
+            trailer[i] = (uint8_t) (gz->crc >> (8 * i));
+            trailer[4 + i] = (uint8_t) (gz->size >> (8 * i));
+        }
+        mg_send(c, trailer, sizeof(trailer));
+        gzip_chunk_end(c, start);
+        mg_http_write_chunk(c, "", 0);
+        gzip_stream_done(c);
+    }
+}
+
+// Reads may reach glue data (memory logs) and the stream count is shared
+static void gzip_stream_cb(struct mg_connection *c, int ev, void *ev_data) {
+    web_lock();
+    gzip_stream_step(c, ev);
+    web_unlock();
+    (void) ev_data;
+}
+
+void http_serve_gzip(struct mg_connection *c, struct mg_http_message *hm,
+                     const char *path, struct mg_http_serve_opts *opts) {
+    struct mg_fs *fs = opts->fs == NULL ? &mg_fs_posix : opts->fs;
+    int bits = web_deflate_bits_for(WEBSERVER_GZIP_MEM);
+    struct mg_str *inm = mg_http_get_header(hm, "If-None-Match");
+    const char *extra = opts->extra_headers ? opts->extra_headers : "";
+    struct gzip_stream *gz;
+    size_t size = 0;
+    time_t mtime = 0;
+    char etag[48];
+    static const uint8_t header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff};
+
+    // Ranges address the uncompressed bytes: leave them to the plain path
+    if (bits == 0 || s_gzip_streams >= WEBSERVER_GZIP_STREAMS ||
+        mg_strcmp(hm->method, mg_str("GET")) != 0 || !gzip_accepted(hm) ||
+        mg_http_get_header(hm, "Range") != NULL ||
+        !(fs->st(path, &size, &mtime) & MG_FS_READ)) {
+        mg_http_serve_file(c, hm, path, opts);
+        return;
+    }
+
+    // Different bytes than the identity encoding, so a different ETag
+    mg_snprintf(etag, sizeof(etag), "\"%lld.%lld.gz\"", (int64_t) mtime,
+                (int64_t) size);
+    if (inm != NULL && mg_strcasecmp(*inm, mg_str(etag)) == 0) {
+        mg_printf(c,
+                  "HTTP/1.1 304 Not Modified\r\nEtag: %s\r\n"
+                  "Vary: Accept-Encoding\r\n%sContent-Length: 0\r\n\r\n",
+                  etag, extra);
+        return;
+    }
+
+    gz = (struct gzip_stream *) mg_calloc(1, sizeof(*gz));
+    if (gz == NULL || !web_deflate_init(&gz->deflate, bits) ||
+        (gz->fd = mg_fs_open(fs, path, MG_FS_READ)) == NULL) {
+        if (gz != NULL) web_deflate_free(&gz->deflate);
+        mg_free(gz);
+        mg_http_serve_file(c, hm, path, opts);
+        return;
+    }
+
+    mg_printf(c,
+              "HTTP/1.1 200 OK\r\n"
+              "Content-Type: text/plain; charset=utf-8\r\n"
+              "Content-Encoding: gzip\r\n"
+              "Transfer-Encoding: chunked\r\n"
+              "Vary: Accept-Encoding\r\n"
+              "Etag: %s\r\n%s\r\n",
+              etag, extra);
+    mg_http_write_chunk(c, (const char *) header, sizeof(header));
+
+    gz->pfn = c->pfn;
+    gz->pfn_data = c->pfn_data;
+    c->pfn = gzip_stream_cb;
+    c->pfn_data = gz;
+    s_gzip_streams++;
+    gzip_stream_step(c, MG_EV_POLL);  // First chunk rides with the headers
 }
 
 // -----------------------------------------------------------------------------
@@ -90,11 +590,131 @@ static struct api_handler *find_api_handler(struct mg_http_message *hm) {
     return NULL;
 }
 
+// -----------------------------------------------------------------------------
+// Streaming Upload (stored in c->data of non-WebSocket connections)
+// -----------------------------------------------------------------------------
+struct upload_state {
+    struct upload_handler *h;  // Active handler, NULL when not uploading
+    void *ctx;                 // Handler context returned by open()
+    uint32_t expected;         // Content-Length of the request
+    uint32_t received;         // Bytes consumed by write() so far
+};
+
+_Static_assert(sizeof(struct upload_state) <= WEB_TCPMETER_ROOM,
+               "upload_state overlaps the connection meter");
+
+static struct upload_handler *find_upload_handler(struct mg_http_message *hm) {
+    extern struct upload_handler s_upload_handlers[];
+
+    for (struct upload_handler *h = s_upload_handlers; h->pattern != NULL; h++) {
+        if (mg_match(hm->uri, mg_str(h->pattern), NULL)) {
+            return h;
+        }
+    }
+    return NULL;
+}
+
+static void upload_finish(struct mg_connection *c, bool complete) {
+    struct upload_state *us = (struct upload_state *) c->data;
+    int err = us->h->close(us->ctx, complete);
+
+    if (err == 0) {
+        char json[64];
+        mg_snprintf(json, sizeof(json), "{\"written\":%lu}",
+                    (unsigned long) us->received);
+        api_reply_ok(c, json);
+    } else {
+        api_reply_fail(c, err, "Upload failed");
+    }
+    MG_DEBUG(("%lu upload done: %lu/%lu bytes, err=%d", c->id,
+              (unsigned long) us->received, (unsigned long) us->expected, err));
+    memset(us, 0, sizeof(*us));
+    mg_iobuf_del(&c->recv, 0, c->recv.len);
+    c->is_full = 0;
+    c->is_draining = 1;
+}
+
+// Hand buffered body bytes to the handler. If it cannot keep up, reads are
+// paused (is_full) so the TCP window closes instead of c->recv growing.
+static void upload_write(struct mg_connection *c) {
+    struct upload_state *us = (struct upload_state *) c->data;
+    size_t remain = us->expected - us->received;
+    size_t len = c->recv.len < remain ? c->recv.len : remain;
+    long n = len > 0 ? us->h->write(us->ctx, us->received, c->recv.buf, len) : 0;
+
+    if (n < 0 || (size_t) n > len) {
+        upload_finish(c, false);
+        return;
+    }
+    us->received += (uint32_t) n;
+    mg_iobuf_del(&c->recv, 0, (size_t) n);
+    if (us->received >= us->expected) {
+        upload_finish(c, true);
+    } else {
+        c->is_full = c->recv.len >= WEBSERVER_UPLOAD_BUF_SIZE;
+    }
+}
+
+// Called on MG_EV_HTTP_HDRS, before the body is buffered
+static void upload_start(struct mg_connection *c, struct mg_http_message *hm) {
+    struct upload_state *us = (struct upload_state *) c->data;
+    struct upload_handler *h = find_upload_handler(hm);
+    struct user *u;
+    int err = 0;
+
+    if (h == NULL) return;  // Regular request, let Mongoose buffer it
+
+    u = glue_authenticate(hm);
+    if (u == NULL) {
+        HTTP_REPLY_401(c);
+    } else if (u->level < h->min_level) {
+        HTTP_REPLY_403(c);
+    } else if (mg_strcmp(hm->method, mg_str("POST")) != 0 ||
+               mg_http_get_header(hm, "Content-Length") == NULL ||
+               hm->body.len == 0 || hm->body.len > UINT32_MAX) {
+        HTTP_REPLY_400(c);
+    } else if ((err = h->open(hm, hm->body.len, &us->ctx)) != 0) {
+        api_reply_fail(c, err, "Upload rejected");
+    } else {
+        MG_DEBUG(("%lu upload %.*s: %lu bytes", c->id, (int) hm->uri.len,
+                  hm->uri.buf, (unsigned long) hm->body.len));
+        us->h = h;
+        us->expected = (uint32_t) hm->body.len;
+        us->received = 0;
+        if (mg_http_get_header(hm, "Expect") != NULL) {
+            mg_printf(c, "HTTP/1.1 100 Continue\r\n\r\n");
+        }
+        // Changing c->recv detaches the HTTP parser: body bytes now arrive
+        // as plain MG_EV_READ events
+        mg_iobuf_del(&c->recv, 0, hm->head.len);
+        upload_write(c);
+        return;
+    }
+
+    // Rejected: discard the body, close once the reply is sent
+    mg_iobuf_del(&c->recv, 0, c->recv.len);
+    c->is_draining = 1;
+}
+
 // -----------------------------------------------------------------------------
 // HTTP Event Handler
 // -----------------------------------------------------------------------------
-void http_ev_handler(struct mg_connection *c, int ev, void *ev_data) {
-    if (ev == MG_EV_HTTP_MSG) {
+static void http_ev_dispatch(struct mg_connection *c, int ev, void *ev_data) {
+    struct upload_state *us = (struct upload_state *) c->data;
+
+    if (c->is_websocket == 0 && us->h != NULL) {
+        // Streaming upload in progress
+        if (ev == MG_EV_READ || (ev == MG_EV_POLL && c->recv.len > 0)) {
+            upload_write(c);
+        } else if (ev == MG_EV_CLOSE) {
+            us->h->close(us->ctx, false);
+            memset(us, 0, sizeof(*us));
+        }
+    }
+    else if (ev == MG_EV_HTTP_HDRS && c->is_websocket == 0) {
+        upload_start(c, (struct mg_http_message *) ev_data);
+    }
+    else if (ev == MG_EV_HTTP_MSG) {
         struct mg_http_message *hm = (struct mg_http_message *) ev_data;
         struct user *u = glue_authenticate(hm);
 
@@ -130,8 +750,12 @@ void http_ev_handler(struct mg_connection *c, int ev, void *ev_data) {
         else if (mg_match(hm->uri, mg_str("/ws"), NULL)) {
             if (u == NULL) {
                 HTTP_REPLY_401(c);
+            } else if (u->level < PERM_ADMIN &&
+                       (mg_http_var(hm->query, mg_str("log")).len > 0 ||
+                        mg_http_var(hm->query, mg_str("tcpstats")).len > 0)) {
+                HTTP_REPLY_403(c);  // Log tail and TCP stats are admin pages
             } else {
-                mg_ws_upgrade(c, hm, NULL);
+                ws_upgrade(c, hm);
             }
         }
         // Static files
@@ -155,4 +779,22 @@ void http_ev_handler(struct mg_connection *c, int ev, void *ev_data) {
         // struct mg_ws_message *wm = (struct mg_ws_message *) ev_data;
         // Handle WebSocket messages if needed
     }
+    else if (ev == MG_EV_POLL && c->is_websocket) {
+        ws_log_flush(c);
+        ws_stats_flush(c);
+    }
+    else if (ev == MG_EV_CLOSE && c->is_websocket) {
+        ws_close(c);
+    }
+}
+
+// With several reactors, handlers run one at a time (webserver_reactor.h).
+// Time spent and bytes moved are charged to the connection's meter.
+void http_ev_handler(struct mg_connection *c, int ev, void *ev_data) {
+    uint64_t start;
+    web_lock();
+    start = web_tcpstats_clock();
+    http_ev_dispatch(c, ev, ev_data);
+    web_tcpstats_account(c, ev, ev_data, start);
+    web_unlock();
 }
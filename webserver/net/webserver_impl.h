@@ -16,6 +16,55 @@ extern "C" {
 #define WEBSERVER_PAGE404 "/webroot/dist/index.html"
 #endif
 
+// Per-connection memory ceiling for WebSocket permessage-deflate (RFC 7692).
+// The compression window is the largest that fits; 0 disables compression.
+#ifndef WEBSERVER_WS_DEFLATE_MEM
+#define WEBSERVER_WS_DEFLATE_MEM 8192
+#endif
+
+// Streaming uploads: unconsumed body bytes buffered before reads are paused
+#ifndef WEBSERVER_UPLOAD_BUF_SIZE
+#define WEBSERVER_UPLOAD_BUF_SIZE 8192
+#endif
+
+// WebSocket log tail: records shared by all subscribers (power of two),
+// longest record text, frame size target, and the send buffer level above
+// which a subscriber is skipped until it catches up
+#ifndef WEBSERVER_WS_LOG_RING
+#define WEBSERVER_WS_LOG_RING 16384
+#endif
+
+#ifndef WEBSERVER_WS_LOG_TEXT_MAX
+#define WEBSERVER_WS_LOG_TEXT_MAX 512
+#endif
+
+#ifndef WEBSERVER_WS_LOG_FRAME
+#define WEBSERVER_WS_LOG_FRAME 8192
+#endif
+
+#ifndef WEBSERVER_WS_LOG_BACKLOG
+#define WEBSERVER_WS_LOG_BACKLOG 32768
+#endif
+
+// WebSocket TCP stats stream (/ws?tcpstats=1): milliseconds between frames
+#ifndef WEBSERVER_WS_TCPSTATS_MS
+#define WEBSERVER_WS_TCPSTATS_MS 1000
+#endif
+
+// Gzip downloads: per-stream memory ceiling for the deflate window, bytes
+// compressed per HTTP chunk, and concurrent streams (others go uncompressed)
+#ifndef WEBSERVER_GZIP_MEM
+#define WEBSERVER_GZIP_MEM 40960
+#endif
+
+#ifndef WEBSERVER_GZIP_CHUNK
+#define WEBSERVER_GZIP_CHUNK 4096
+#endif
+
+#ifndef WEBSERVER_GZIP_STREAMS
+#define WEBSERVER_GZIP_STREAMS 2
+#endif
+
 // -----------------------------------------------------------------------------
 // User structure for authentication
 // -----------------------------------------------------------------------------
@@ -39,6 +88,28 @@ struct api_handler {
     api_handler_fn handler;  // Handler function
 };
 
+// Streaming upload handlers: the request body is handed to write() as it
+// arrives instead of being buffered in hm->body.
+//   open()  - validate the request, return 0 or an ERR_xxx code
+//   write() - consume up to len bytes at offset, return bytes consumed
+//             (may be less, e.g. to keep flash page alignment; must take
+//             everything once offset + len reaches the end), or -1 on error
+//   close() - complete is false if the transfer or a write failed;
+//             return 0 on success or an ERR_xxx code for the reply
+typedef int (*upload_open_fn)(struct mg_http_message *hm, size_t size,
+                              void **ctx);
+typedef long (*upload_write_fn)(void *ctx, size_t offset,
+                                const void *buf, size_t len);
+typedef int (*upload_close_fn)(void *ctx, bool complete);
+
+struct upload_handler {
+    const char *pattern;     // URL pattern (e.g., "/api/firmware/stream")
+    int min_level;           // Minimum permission level required
+    upload_open_fn open;
+    upload_write_fn write;
+    upload_close_fn close;
+};
+
 // -----------------------------------------------------------------------------
 // HTTP Error Response Macros (Protocol layer)
 // -----------------------------------------------------------------------------
@@ -54,11 +125,22 @@ struct api_handler {
 void api_reply_ok(struct mg_connection *c, const char *data_json);
 void api_reply_fail(struct mg_connection *c, int code, const char *message);
 
+// Serve a file like mg_http_serve_file(), gzip-compressed on the fly when
+// the client accepts it. Meant for text: the gzip reply is text/plain.
+// Range and HEAD requests are served uncompressed.
+void http_serve_gzip(struct mg_connection *c, struct mg_http_message *hm,
+                     const char *path, struct mg_http_serve_opts *opts);
+
 // -----------------------------------------------------------------------------
-// WebSocket Broadcast
+// WebSocket Send / Broadcast
 // -----------------------------------------------------------------------------
+void ws_send_text(struct mg_connection *c, const char *buf, size_t len);
 void ws_broadcast(struct mg_mgr *mgr, const char *json);
 
+// Queue a log record for /ws?log=... subscribers. module indexes the
+// glue layer's s_log_modules[] name table (NULL-terminated).
+void ws_log_publish(int level, int module, const char *text, size_t len);
+
 // -----------------------------------------------------------------------------
 // HTTP Event Handler (called by glue layer)
 // -----------------------------------------------------------------------------
@@ -0,0 +1,160 @@
+// Copyright (c) 2026
+// Web Server Log - Buffered, batched sink for MG_LOG output
+
+#include "webserver_log.h"
+#include "webserver_reactor.h"
+
+// Reactors log from several threads: a record is built between
+// mg_log_prefix() and mg_log(), so the lock spans both calls
+#if WEBSERVER_REACTORS > 1
+#include <pthread.h>
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+#define LOG_LOCK() pthread_mutex_lock(&s_lock)
+#define LOG_UNLOCK() pthread_mutex_unlock(&s_lock)
+#else
+#define LOG_LOCK()
+#define LOG_UNLOCK()
+#endif
+
+static char s_buf[WEB_LOG_BUF_SIZE];    // Records awaiting flush
+static size_t s_len;
+static char s_line[WEB_LOG_LINE_SIZE];  // Record being formatted
+static size_t s_line_len;
+static int s_line_level;
+static bool s_line_cut;
+static bool s_batched;                  // Flush timer running
+static struct web_log_stats s_stats;
+
+// -----------------------------------------------------------------------------
+// Line buffer
+// -----------------------------------------------------------------------------
+static void flush(void) {
+    if (s_len == 0) return;
+    fwrite(s_buf, 1, s_len, stdout);
+    fflush(stdout);
+    s_stats.flushes++;
+    s_stats.bytes += s_len;
+    s_len = 0;
+}
+
+static void line_commit(void) {
+    if (s_len + s_line_len + 1 > sizeof(s_buf)) flush();
+    memcpy(s_buf + s_len, s_line, s_line_len);
+    s_len += s_line_len;
+    s_buf[s_len++] = '\n';
+    s_stats.records++;
+    if (s_line_cut) s_stats.truncated++;
+    if (!s_batched || s_line_level == MG_LL_ERROR) flush();
+    s_line_len = 0;
+    s_line_level = MG_LL_NONE;
+    s_line_cut = false;
+}
+
+// Keep one record per line
+static void line_sanitize(size_t from) {
+    size_t i;
+    for (i = from; i < s_line_len; i++) {
+        if ((unsigned char) s_line[i] < ' ') s_line[i] = ' ';
+    }
+}
+
+// mg_hexdump() still emits one character at a time via mg_log_set_fn()
+static void log_putc(char ch, void *param) {
+    if (ch == '\r') return;
+    LOG_LOCK();
+    if (ch == '\n') {
+        line_commit();
+        LOG_UNLOCK();
+        return;
+    }
+#if MG_ENABLE_CUSTOM_LOG
+    if (s_line_len == 0) {
+        s_line_len = mg_snprintf(s_line, sizeof(s_line), "%llu - -:0 -: ",
+                                 (unsigned long long) mg_millis());
+    }
+#endif
+    if (s_line_len < sizeof(s_line) - 1) {
+        s_line[s_line_len++] = (unsigned char) ch < ' ' ? ' ' : ch;
+    } else {
+        s_line_cut = true;
+    }
+    LOG_UNLOCK();
+    (void) param;
+}
+
+// -----------------------------------------------------------------------------
+// Mongoose log hooks (MG_ENABLE_CUSTOM_LOG=1)
+// -----------------------------------------------------------------------------
+#if MG_ENABLE_CUSTOM_LOG
+static char level_char(int level) {
+    switch (level) {
+        case MG_LL_ERROR: return 'E';
+        case MG_LL_INFO: return 'I';
+        case MG_LL_DEBUG: return 'D';
+        default: return 'V';
+    }
+}
+
+void mg_log_prefix(int level, const char *file, int line, const char *fname) {
+    const char *p = strrchr(file, '/');
+    size_t n;
+    if (p == NULL) p = strrchr(file, '\\');
+    LOG_LOCK();  // Released by mg_log()
+    if (s_line_len > 0) line_commit();  // Unterminated hexdump output
+    n = mg_snprintf(s_line, sizeof(s_line), "%llu %c %s:%d %s: ",
+                    (unsigned long long) mg_millis(), level_char(level),
+                    p == NULL ? file : p + 1, line, fname);
+    s_line_len = n < sizeof(s_line) ? n : sizeof(s_line) - 1;
+    s_line_level = level;
+}
+
+void mg_log(const char *fmt, ...) {
+    size_t room = sizeof(s_line) - s_line_len, n, start = s_line_len;
+    va_list ap;
+    va_start(ap, fmt);
+    n = mg_vsnprintf(s_line + s_line_len, room, fmt, &ap);
+    va_end(ap);
+    if (n >= room) {
+        n = room - 1;
+        s_line_cut = true;
+    }
+    s_line_len += n;
+    line_sanitize(start);
+    line_commit();
+    LOG_UNLOCK();
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+void web_log_flush(void) {
+    LOG_LOCK();
+    flush();
+    LOG_UNLOCK();
+}
+
+static void timer_flush(void *arg) {
+    web_log_flush();
+    (void) arg;
+}
+
+void web_log_init(struct mg_mgr *mgr) {
+    mg_log_set_fn(log_putc, NULL);
+    mg_timer_add(mgr, WEB_LOG_FLUSH_MS, MG_TIMER_REPEAT, timer_flush, NULL);
+    s_batched = true;
+    atexit(web_log_exit);
+}
+
+void web_log_exit(void) {
+    LOG_LOCK();
+    flush();
+    s_batched = false;  // The flush timer goes away with its mg_mgr
+    LOG_UNLOCK();
+}
+
+void web_log_get_stats(struct web_log_stats *st) {
+    LOG_LOCK();
+    *st = s_stats;
+    LOG_UNLOCK();
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2026
+// Web Server Log - Buffered, batched sink for MG_LOG output
+#pragma once
+
+#include "mongoose.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------------
+// Configuration
+// -----------------------------------------------------------------------------
+#ifndef WEB_LOG_BUF_SIZE
+#define WEB_LOG_BUF_SIZE 16384  // Formatted records held between flushes
+#endif
+
+#ifndef WEB_LOG_LINE_SIZE
+#define WEB_LOG_LINE_SIZE 256   // Longest record, longer ones are truncated
+#endif
+
+#ifndef WEB_LOG_FLUSH_MS
+#define WEB_LOG_FLUSH_MS 100    // Batch flush interval
+#endif
+
+// -----------------------------------------------------------------------------
+// Record format
+// -----------------------------------------------------------------------------
+// One record per line, fields separated by single spaces:
+//
+//   <uptime_ms> <level> <file>:<line> <func>: <message>
+//
+// uptime_ms is mg_millis() in decimal, level is one of E I D V. Control
+// characters in the message are replaced with spaces, so a record never
+// spans lines. Raw mg_hexdump() lines carry level and source "-".
+//
+// Records are formatted on the event loop thread and written to stdout in
+// batches: every WEB_LOG_FLUSH_MS, when the buffer fills up, and right away
+// for ERROR records. Until web_log_init() runs and after web_log_exit(),
+// every record is flushed immediately.
+struct web_log_stats {
+    uint64_t records;    // Records formatted
+    uint64_t truncated;  // Records cut at WEB_LOG_LINE_SIZE
+    uint64_t flushes;    // Batches written
+    uint64_t bytes;      // Bytes written
+};
+
+// Install the sink and start the flush timer
+void web_log_init(struct mg_mgr *mgr);
+
+// Write out everything buffered so far
+void web_log_flush(void);
+
+// Flush and stop batching; call on shutdown. Also registered with atexit()
+// by web_log_init(), for exits that bypass main().
+void web_log_exit(void);
+
+void web_log_get_stats(struct web_log_stats *st);
+
+#ifdef __cplusplus
+}
+#endif
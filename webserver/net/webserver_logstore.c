@@ -0,0 +1,269 @@
+// Copyright (c) 2026
+// Web Server Log Store - Persistent, segmented log record store
+
+#include "webserver_logstore.h"
+
+// -----------------------------------------------------------------------------
+// On-disk format, all integers little-endian
+// -----------------------------------------------------------------------------
+// Segment file <dir>/segN.wls:
+//   header  magic "WLS1", u32 generation, u32 first sequence, u32 crc
+//   records appended back to back until the segment is full
+//
+// Record:
+//   u32 seq, u32 time, u16 len, u8 level, u8 module, u32 crc, text[len]
+//
+// Both CRCs are CRC-32 over everything before them (for records, the text
+// as well). Sequence numbers are consecutive within a segment, so a
+// scan stops at the first torn or stale record.
+#define SEG_MAGIC "WLS1"
+#define SEG_HDR_SIZE 16
+#define REC_HDR_SIZE 16
+
+static void put16(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t) v, p[1] = (uint8_t) (v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    put16(p, v), put16(p + 2, v >> 16);
+}
+
+static uint32_t get16(const uint8_t *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return get16(p) | (get16(p + 2) << 16);
+}
+
+static uint32_t crc32(const void *buf, size_t len, uint32_t crc) {
+    return mg_crc32(crc, (const char *) buf, len);
+}
+
+// -----------------------------------------------------------------------------
+// Segments
+// -----------------------------------------------------------------------------
+static void seg_path(const struct web_logstore *st, int i, char *buf,
+                     size_t len) {
+    mg_snprintf(buf, len, "%s/seg%d.wls", st->dir, i);
+}
+
+// Account for a record of len text bytes appended at s->size
+static void seg_add(struct web_logstore_seg *s, size_t len) {
+    uint32_t k = (s->text_len + WEB_LOGSTORE_INDEX_STEP - 1) /
+                 WEB_LOGSTORE_INDEX_STEP;
+    for (; k * WEB_LOGSTORE_INDEX_STEP < s->text_len + len; k++) {
+        s->index[k].file_off = s->size;
+        s->index[k].text_off = s->text_len;
+    }
+    s->count++;
+    s->size += (uint32_t) (REC_HDR_SIZE + len);
+    s->text_len += (uint32_t) len;
+}
+
+// Rebuild the index of slot i from its file; returns true if the file
+// holds bytes past the last valid record
+static bool seg_scan(struct web_logstore *st, int i) {
+    struct web_logstore_seg *s = &st->seg[i];
+    uint8_t hdr[REC_HDR_SIZE];
+    char path[160], text[WEB_LOGSTORE_MAX_TEXT];
+    size_t fsize = 0;
+    void *fd;
+
+    memset(s, 0, sizeof(*s));
+    seg_path(st, i, path, sizeof(path));
+    if ((fd = st->fs->op(path, MG_FS_READ)) == NULL) return false;
+
+    if (st->fs->rd(fd, hdr, SEG_HDR_SIZE) == SEG_HDR_SIZE &&
+        memcmp(hdr, SEG_MAGIC, 4) == 0 && get32(hdr + 4) != 0 &&
+        get32(hdr + 12) == crc32(hdr, 12, 0)) {
+        s->gen = get32(hdr + 4);
+        s->first_seq = get32(hdr + 8);
+        s->size = SEG_HDR_SIZE;
+        while (st->fs->rd(fd, hdr, REC_HDR_SIZE) == REC_HDR_SIZE) {
+            size_t len = get16(hdr + 8);
+            if (get32(hdr) != s->first_seq + s->count || len == 0 ||
+                len > sizeof(text) ||
+                s->size + REC_HDR_SIZE + len > WEB_LOGSTORE_SEG_SIZE ||
+                st->fs->rd(fd, text, len) != len ||
+                get32(hdr + 12) != crc32(text, len, crc32(hdr, 12, 0))) {
+                break;
+            }
+            seg_add(s, len);
+        }
+    }
+    st->fs->cl(fd);
+    st->fs->st(path, &fsize, NULL);
+    return fsize != s->size;
+}
+
+// Used slots sorted by generation, oldest first
+static void seg_sort(struct web_logstore *st) {
+    int i, j;
+    st->nused = 0;
+    for (i = 0; i < WEB_LOGSTORE_SEGMENTS; i++) {
+        if (st->seg[i].gen == 0) continue;
+        for (j = st->nused++; j > 0 && st->seg[st->order[j - 1]].gen >
+                                           st->seg[i].gen; j--) {
+            st->order[j] = st->order[j - 1];
+        }
+        st->order[j] = i;
+    }
+}
+
+static bool seg_write(struct web_logstore *st, int i, const void *a,
+                      size_t alen, const void *b, size_t blen) {
+    char path[160];
+    bool ok;
+    void *fd;
+    seg_path(st, i, path, sizeof(path));
+    if ((fd = st->fs->op(path, MG_FS_WRITE)) == NULL) return false;
+    ok = st->fs->wr(fd, a, alen) == alen &&
+         (blen == 0 || st->fs->wr(fd, b, blen) == blen);
+    st->fs->cl(fd);
+    return ok;
+}
+
+// Start a new segment in a free slot, or in place of the oldest one. The
+// old file is deleted first, so a crash leaves either the old segment or
+// a (possibly empty) new one, never a mix.
+static bool seg_rotate(struct web_logstore *st) {
+    struct web_logstore_seg *s;
+    uint8_t hdr[SEG_HDR_SIZE];
+    char path[160];
+    int i, slot = -1;
+
+    for (i = 0; i < WEB_LOGSTORE_SEGMENTS && slot < 0; i++) {
+        if (st->seg[i].gen == 0) slot = i;
+    }
+    if (slot < 0) slot = st->order[0];
+    s = &st->seg[slot];
+    st->base += s->text_len;
+    seg_path(st, slot, path, sizeof(path));
+    st->fs->rm(path);
+    memset(s, 0, sizeof(*s));
+
+    memcpy(hdr, SEG_MAGIC, 4);
+    put32(hdr + 4, st->gen + 1);
+    put32(hdr + 8, st->next_seq);
+    put32(hdr + 12, crc32(hdr, 12, 0));
+    if (seg_write(st, slot, hdr, sizeof(hdr), NULL, 0)) {
+        s->gen = ++st->gen;
+        s->first_seq = st->next_seq;
+        s->size = SEG_HDR_SIZE;
+        st->cur = slot;
+    }
+    seg_sort(st);
+    return s->gen != 0;
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+bool web_logstore_open(struct web_logstore *st, struct mg_fs *fs,
+                       const char *dir) {
+    bool torn[WEB_LOGSTORE_SEGMENTS];
+    int i;
+
+    memset(st, 0, sizeof(*st));
+    st->fs = fs;
+    st->cur = -1;
+    st->next_seq = 1;
+    mg_snprintf(st->dir, sizeof(st->dir), "%s", dir);
+    if (!(fs->st(dir, NULL, NULL) & MG_FS_DIR)) fs->mkd(dir);
+    if (!(fs->st(dir, NULL, NULL) & MG_FS_DIR)) return false;
+
+    for (i = 0; i < WEB_LOGSTORE_SEGMENTS; i++) torn[i] = seg_scan(st, i);
+    seg_sort(st);
+    if (st->nused > 0) {
+        struct web_logstore_seg *s = &st->seg[st->order[st->nused - 1]];
+        st->gen = s->gen;
+        st->next_seq = s->first_seq + s->count;
+        // Appending after garbage would make the new records unreachable
+        if (!torn[st->order[st->nused - 1]]) st->cur = st->order[st->nused - 1];
+    }
+    if (st->next_seq == 0) st->next_seq = 1;
+
+    MG_INFO(("Log store %s: %d segments, %lu bytes, next seq %lu", dir,
+             st->nused, (unsigned long) web_logstore_size(st),
+             (unsigned long) st->next_seq));
+    return true;
+}
+
+uint32_t web_logstore_append(struct web_logstore *st, time_t time, int level,
+                             int module, const char *text, size_t len) {
+    uint8_t hdr[REC_HDR_SIZE];
+    uint32_t seq = st->next_seq;
+
+    if (len > WEB_LOGSTORE_MAX_TEXT) len = WEB_LOGSTORE_MAX_TEXT;
+    if (len == 0) return 0;
+    if (st->cur >= 0 &&
+        st->seg[st->cur].size + REC_HDR_SIZE + len > WEB_LOGSTORE_SEG_SIZE) {
+        st->cur = -1;
+    }
+    if (st->cur < 0 && !seg_rotate(st)) return 0;
+
+    put32(hdr, seq);
+    put32(hdr + 4, (uint32_t) time);
+    put16(hdr + 8, (uint32_t) len);
+    hdr[10] = (uint8_t) level;
+    hdr[11] = (uint8_t) module;
+    put32(hdr + 12, crc32(text, len, crc32(hdr, 12, 0)));
+    if (!seg_write(st, st->cur, hdr, sizeof(hdr), text, len)) {
+        st->cur = -1;  // Possibly torn, continue in a fresh segment
+        return 0;
+    }
+    seg_add(&st->seg[st->cur], len);
+    if (++st->next_seq == 0) st->next_seq = 1;
+    return seq;
+}
+
+size_t web_logstore_size(const struct web_logstore *st) {
+    size_t n = 0;
+    int i;
+    for (i = 0; i < st->nused; i++) n += st->seg[st->order[i]].text_len;
+    return n;
+}
+
+size_t web_logstore_read(struct web_logstore *st, size_t offset, void *buf,
+                         size_t len) {
+    uint8_t hdr[REC_HDR_SIZE];
+    char path[160], text[WEB_LOGSTORE_MAX_TEXT];
+    size_t done = 0;
+    int i;
+
+    for (i = 0; i < st->nused && done < len; i++) {
+        int slot = st->order[i];
+        struct web_logstore_seg *s = &st->seg[slot];
+        const struct web_logstore_ckpt *ck;
+        size_t pos;
+        void *fd;
+
+        if (offset >= s->text_len) {
+            offset -= s->text_len;
+            continue;
+        }
+        seg_path(st, slot, path, sizeof(path));
+        if ((fd = st->fs->op(path, MG_FS_READ)) == NULL) break;
+        ck = &s->index[offset / WEB_LOGSTORE_INDEX_STEP];
+        st->fs->sk(fd, ck->file_off);
+        for (pos = ck->text_off; done < len && pos < s->text_len;) {
+            size_t n, skip, copy;
+            if (st->fs->rd(fd, hdr, REC_HDR_SIZE) != REC_HDR_SIZE) break;
+            n = get16(hdr + 8);
+            if (n > sizeof(text) || st->fs->rd(fd, text, n) != n) break;
+            if (offset < pos + n) {
+                skip = offset - pos;
+                copy = n - skip < len - done ? n - skip : len - done;
+                memcpy((char *) buf + done, text + skip, copy);
+                done += copy;
+                offset += copy;
+            }
+            pos += n;
+        }
+        st->fs->cl(fd);
+        if (done < len && pos < s->text_len) break;  // Short read
+        offset = 0;
+    }
+    return done;
+}
@@ -0,0 +1,85 @@
+// Copyright (c) 2026
+// Web Server Log Store - Persistent, segmented log record store
+#pragma once
+
+#include "mongoose.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------------
+// Configuration
+// -----------------------------------------------------------------------------
+#ifndef WEB_LOGSTORE_SEGMENTS
+#define WEB_LOGSTORE_SEGMENTS 4       // Segment files, the oldest is recycled
+#endif
+
+#ifndef WEB_LOGSTORE_SEG_SIZE
+#define WEB_LOGSTORE_SEG_SIZE 16384   // Bytes per segment file
+#endif
+
+#ifndef WEB_LOGSTORE_INDEX_STEP
+#define WEB_LOGSTORE_INDEX_STEP 256   // Text bytes between index checkpoints
+#endif
+
+#define WEB_LOGSTORE_MAX_TEXT 512     // Longest record text
+
+// -----------------------------------------------------------------------------
+// Store state
+// -----------------------------------------------------------------------------
+// Records are appended to the newest segment. When it is full, the oldest
+// segment is deleted and restarted with a higher generation number, so the
+// store keeps between (SEGMENTS - 1) and SEGMENTS segments of history.
+//
+// The text of all records, oldest first, forms one contiguous log file.
+// Every WEB_LOGSTORE_INDEX_STEP bytes of that text a checkpoint remembers
+// which record covers it, so a read at any offset seeks straight to a
+// record no more than one step before it.
+struct web_logstore_ckpt {
+    uint32_t file_off;  // Record header offset within the segment file
+    uint32_t text_off;  // Text offset of that record within the segment
+};
+
+struct web_logstore_seg {
+    uint32_t gen;        // Generation, 0 = slot unused
+    uint32_t first_seq;  // Sequence number of the first record
+    uint32_t count;      // Valid records
+    uint32_t size;       // Valid bytes in the file, header included
+    uint32_t text_len;   // Text bytes held by the valid records
+    struct web_logstore_ckpt index[WEB_LOGSTORE_SEG_SIZE /
+                                   WEB_LOGSTORE_INDEX_STEP + 1];
+};
+
+struct web_logstore {
+    struct mg_fs *fs;
+    char dir[128];
+    struct web_logstore_seg seg[WEB_LOGSTORE_SEGMENTS];
+    int order[WEB_LOGSTORE_SEGMENTS];  // Used slots, oldest first
+    int nused;
+    int cur;             // Slot receiving appends, -1 = rotate first
+    uint32_t gen;        // Newest generation
+    uint32_t next_seq;   // Sequence number of the next record
+    size_t base;         // Text bytes dropped with recycled segments, so
+                         // base + offset stays stable across rotations
+};
+
+// Open the store in dir (created if missing), recovering the index from the
+// segment files. Torn records left by a crash end their segment.
+bool web_logstore_open(struct web_logstore *st, struct mg_fs *fs,
+                       const char *dir);
+
+// Append one record; returns its sequence number, or 0 on failure
+uint32_t web_logstore_append(struct web_logstore *st, time_t time, int level,
+                             int module, const char *text, size_t len);
+
+// Total text bytes held by the store
+size_t web_logstore_size(const struct web_logstore *st);
+
+// Copy up to len bytes of text starting at offset; returns bytes copied
+size_t web_logstore_read(struct web_logstore *st, size_t offset, void *buf,
+                         size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,151 @@
+// Copyright (c) 2026
+// Web Server Queue - Bounded multi-producer queue into the event loop
+
+#include "webserver_queue.h"
+
+// Slot: header followed by item_size bytes of payload. seq == position
+// means free for that lap, position + 1 means filled.
+struct slot_hdr {
+    _Atomic size_t seq;
+    size_t len;
+};
+
+#define SLOT_ALIGN 16
+
+static struct slot_hdr *slot_at(struct web_queue *q, size_t pos) {
+    return (struct slot_hdr *) (q->slots + (pos & q->mask) * q->slot_size);
+}
+
+// Socketless connection: skipped by the I/O poll, but receives MG_EV_POLL
+// and the MG_EV_WAKEUP sent by producers
+static void queue_ev(struct mg_connection *c, int ev, void *ev_data) {
+    struct web_queue *q = (struct web_queue *) c->fn_data;
+    if ((ev == MG_EV_WAKEUP || ev == MG_EV_POLL) && q->slots != NULL) {
+        web_queue_drain(q);
+    } else if (ev == MG_EV_CLOSE) {
+        atomic_store(&q->conn_id, 0);
+    }
+    (void) ev_data;
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+bool web_queue_init(struct web_queue *q, struct mg_mgr *mgr, size_t capacity,
+                    size_t item_size, web_queue_fn fn, void *arg) {
+    struct mg_connection *c;
+    size_t i;
+
+    memset(q, 0, sizeof(*q));
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) return false;
+    q->mgr = mgr;
+    q->item_size = item_size;
+    q->slot_size = (sizeof(struct slot_hdr) + item_size + SLOT_ALIGN - 1) /
+                   SLOT_ALIGN * SLOT_ALIGN;
+    q->mask = capacity - 1;
+    q->fn = fn;
+    q->arg = arg;
+    if ((q->slots = (uint8_t *) mg_calloc(capacity, q->slot_size)) == NULL) {
+        return false;
+    }
+    for (i = 0; i < capacity; i++) atomic_init(&slot_at(q, i)->seq, i);
+    atomic_init(&q->head, 0);
+    atomic_init(&q->wake_pending, false);
+    atomic_init(&q->dropped, 0);
+    atomic_init(&q->wakeups, 0);
+    atomic_init(&q->conn_id, 0);
+
+    if (!mg_wakeup_init(mgr) && mgr->pipe == MG_INVALID_SOCKET) {
+        MG_ERROR(("Queue: no wakeup pipe, falling back to poll"));
+    }
+    if ((c = mg_wrapfd(mgr, (int) MG_INVALID_SOCKET, queue_ev, q)) == NULL) {
+        mg_free(q->slots);
+        q->slots = NULL;
+        return false;
+    }
+    atomic_store(&q->conn_id, c->id);
+    return true;
+}
+
+bool web_queue_push(struct web_queue *q, const void *item, size_t len) {
+    size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+    struct slot_hdr *s;
+
+    if (len > q->item_size) return false;
+    for (;;) {
+        intptr_t diff;
+        s = slot_at(q, pos);
+        diff = (intptr_t) atomic_load_explicit(&s->seq, memory_order_acquire) -
+               (intptr_t) pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&q->dropped, 1, memory_order_relaxed);
+            return false;  // Full: the consumer has not freed this slot yet
+        } else {
+            pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+        }
+    }
+    memcpy(s + 1, item, len);
+    s->len = len;
+    atomic_store_explicit(&s->seq, pos + 1, memory_order_release);
+
+    // Only the first push since the last drain wakes the reactor
+    if (!atomic_exchange(&q->wake_pending, true)) {
+        unsigned long id = atomic_load(&q->conn_id);
+        if (id != 0) {
+            atomic_fetch_add_explicit(&q->wakeups, 1, memory_order_relaxed);
+            mg_wakeup(q->mgr, id, "", 0);
+        }
+    }
+    return true;
+}
+
+size_t web_queue_drain(struct web_queue *q) {
+    size_t n = 0;
+
+    // Cleared before reading, so an item published after the scan below
+    // passes its slot always triggers a new wakeup
+    atomic_store(&q->wake_pending, false);
+    for (;;) {
+        struct slot_hdr *s = slot_at(q, q->tail);
+        if (atomic_load_explicit(&s->seq, memory_order_acquire) != q->tail + 1) {
+            break;
+        }
+        q->fn(s + 1, s->len, q->arg);
+        atomic_store_explicit(&s->seq, q->tail + q->mask + 1,
+                              memory_order_release);
+        q->tail++;
+        n++;
+    }
+    if (n > 0) {
+        q->pushed += n;
+        q->batches++;
+        if (q->done != NULL) q->done(q->arg);
+    }
+    return n;
+}
+
+void web_queue_free(struct web_queue *q) {
+    unsigned long id = atomic_exchange(&q->conn_id, 0);
+    struct mg_connection *c;
+
+    if (q->slots == NULL) return;
+    web_queue_drain(q);
+    for (c = q->mgr->conns; c != NULL; c = c->next) {
+        if (c->id == id) c->is_closing = 1;
+    }
+    mg_free(q->slots);
+    q->slots = NULL;
+}
+
+void web_queue_get_stats(struct web_queue *q, struct web_queue_stats *st) {
+    st->pushed = q->pushed;
+    st->dropped = atomic_load_explicit(&q->dropped, memory_order_relaxed);
+    st->wakeups = atomic_load_explicit(&q->wakeups, memory_order_relaxed);
+    st->batches = q->batches;
+}
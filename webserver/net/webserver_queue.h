@@ -0,0 +1,75 @@
+// Copyright (c) 2026
+// Web Server Queue - Bounded multi-producer queue into the event loop
+#pragma once
+
+#include "mongoose.h"
+
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------------
+// Queue state
+// -----------------------------------------------------------------------------
+// Any thread may push; items are consumed on the thread running
+// mg_mgr_poll(). Each slot carries a sequence number (Vyukov's bounded
+// queue), so producers only contend on one atomic counter and never wait
+// for each other or for the consumer.
+//
+// The first push after a drain sends one mg_wakeup(); later pushes see the
+// wakeup pending and skip it, so a burst of N items costs one pipe write.
+// The reactor then hands every item present to fn in one pass. MG_EV_POLL
+// drains as well, in case a wakeup was lost to a full pipe.
+typedef void (*web_queue_fn)(const void *item, size_t len, void *arg);
+typedef void (*web_queue_done_fn)(void *arg);
+
+struct web_queue_stats {
+    uint64_t pushed;    // Items delivered to fn
+    uint64_t dropped;   // Pushes refused because the queue was full
+    uint64_t wakeups;   // mg_wakeup() calls made by producers
+    uint64_t batches;   // Drains that delivered at least one item
+};
+
+struct web_queue {
+    struct mg_mgr *mgr;
+    atomic_ulong conn_id;       // Consumer connection, target of mg_wakeup()
+    uint8_t *slots;             // capacity * slot_size bytes
+    size_t slot_size;           // Slot header + item_size, aligned
+    size_t item_size;           // Largest item
+    size_t mask;                // capacity - 1
+    // Producer and consumer counters on separate cache lines
+    _Alignas(64) _Atomic size_t head;  // Next slot claimed by a producer
+    atomic_bool wake_pending;          // A wakeup is in flight
+    _Alignas(64) size_t tail;          // Next slot read by the consumer
+    atomic_ulong dropped;
+    atomic_ulong wakeups;
+    uint64_t pushed, batches;
+    web_queue_fn fn;
+    web_queue_done_fn done;     // Optional, set after init: called once
+                                // after a drain that delivered items
+    void *arg;
+};
+
+// Set up a queue of capacity (power of two) items of up to item_size bytes
+// each, delivered to fn on the event loop. Call from the event loop thread.
+bool web_queue_init(struct web_queue *q, struct mg_mgr *mgr, size_t capacity,
+                    size_t item_size, web_queue_fn fn, void *arg);
+
+// Copy an item in; any thread. Returns false if it is too big or the queue
+// is full (the item is dropped, never blocks).
+bool web_queue_push(struct web_queue *q, const void *item, size_t len);
+
+// Deliver every queued item to fn; event loop thread only. Returns count.
+size_t web_queue_drain(struct web_queue *q);
+
+// Deliver what is left, close the consumer connection and release the
+// slots; event loop thread, or once no thread pushes or polls any more
+void web_queue_free(struct web_queue *q);
+
+void web_queue_get_stats(struct web_queue *q, struct web_queue_stats *st);
+
+#ifdef __cplusplus
+}
+#endif
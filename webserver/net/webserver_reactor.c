@@ -0,0 +1,266 @@
+// Copyright (c) 2026
+// Web Server Reactors - Optional multi-threaded event loops (Linux)
+
+#define _GNU_SOURCE  // PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP
+
+#include "webserver_reactor.h"
+#include "webserver_impl.h"
+
+#if WEBSERVER_REACTORS > 1
+
+#include "webserver_queue.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+
+#define MAX_LISTENERS 4
+
+struct listener {
+    const char *url;
+    mg_event_handler_t fn;
+    void *fn_data;
+};
+
+struct reactor {
+    struct mg_mgr *mgr;
+    struct mg_mgr own;        // Storage for reactors 1..N-1
+    struct web_queue queue;   // Broadcasts from the other reactors
+    pthread_t thread;
+    bool running;             // thread was created, join it on stop
+};
+
+// One broadcast, shared by the reactors it was posted to
+struct bcast {
+    atomic_int refs;
+    char json[];
+};
+
+static struct reactor s_reactors[WEBSERVER_REACTORS];
+static struct listener s_listeners[MAX_LISTENERS];
+static int s_nlisteners;
+static atomic_bool s_started;  // Reactor table complete, broadcasts allowed
+static atomic_bool s_stop;     // Set by web_reactors_stop()
+// Recursive, so handlers may call back into locked helpers
+static pthread_mutex_t s_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+// -----------------------------------------------------------------------------
+// Shared state lock
+// -----------------------------------------------------------------------------
+void web_lock(void) {
+    pthread_mutex_lock(&s_lock);
+}
+
+void web_unlock(void) {
+    pthread_mutex_unlock(&s_lock);
+}
+
+// -----------------------------------------------------------------------------
+// SO_REUSEPORT listener
+// -----------------------------------------------------------------------------
+// Mongoose binds without SO_REUSEPORT, so let mg_http_listen() set up the
+// connection (HTTP protocol handler, TLS flag) on an ephemeral port, then
+// swap in a socket bound to the real port with SO_REUSEPORT set.
+static struct mg_connection *listen_reuseport(struct mg_mgr *mgr,
+                                              const char *url,
+                                              mg_event_handler_t fn,
+                                              void *fn_data) {
+    union {
+        struct sockaddr sa;
+        struct sockaddr_in sin;
+        struct sockaddr_in6 sin6;
+    } usa;
+    struct mg_str host = mg_url_host(url);
+    struct mg_addr addr;
+    struct mg_connection *c;
+    socklen_t slen;
+    char tmp[96];
+    int fd, on = 1;
+
+    memset(&addr, 0, sizeof(addr));
+    memset(&usa, 0, sizeof(usa));
+    if (!mg_aton(host, &addr)) {
+        MG_ERROR(("Reactor: bad listen address %s", url));
+        return NULL;
+    }
+    addr.port = mg_htons(mg_url_port(url));
+    if (addr.is_ip6) {
+        usa.sin6.sin6_family = AF_INET6;
+        usa.sin6.sin6_port = addr.port;
+        memcpy(&usa.sin6.sin6_addr, addr.ip, 16);
+        slen = sizeof(usa.sin6);
+    } else {
+        usa.sin.sin_family = AF_INET;
+        usa.sin.sin_port = addr.port;
+        memcpy(&usa.sin.sin_addr, &addr.ip4, 4);
+        slen = sizeof(usa.sin);
+    }
+
+    fd = socket(usa.sa.sa_family, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0 ||
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) != 0 ||
+        bind(fd, &usa.sa, slen) != 0 || listen(fd, MG_SOCK_LISTEN_BACKLOG_SIZE) != 0) {
+        MG_ERROR(("Reactor: cannot listen on %s, errno %d", url, errno));
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+
+    mg_snprintf(tmp, sizeof(tmp), "%s://%s%.*s%s:0",
+                mg_url_is_ssl(url) ? "https" : "http", addr.is_ip6 ? "[" : "",
+                (int) host.len, host.buf, addr.is_ip6 ? "]" : "");
+    if ((c = mg_http_listen(mgr, tmp, fn, fn_data)) == NULL) {
+        close(fd);
+        return NULL;
+    }
+    close((int) (size_t) c->fd);  // Also drops it from the epoll set
+    c->fd = (void *) (size_t) fd;
+    c->loc = addr;
+    MG_EPOLL_ADD(c);
+    return c;
+}
+
+// -----------------------------------------------------------------------------
+// Reactors
+// -----------------------------------------------------------------------------
+static void broadcast_cb(const void *item, size_t len, void *arg) {
+    struct reactor *r = (struct reactor *) arg;
+    struct bcast *b = *(struct bcast *const *) item;
+    size_t n = strlen(b->json);
+
+    for (struct mg_connection *c = r->mgr->conns; c != NULL; c = c->next) {
+        if (c->is_websocket) ws_send_text(c, b->json, n);
+    }
+    if (atomic_fetch_sub(&b->refs, 1) == 1) mg_free(b);
+    (void) len;
+}
+
+static void *reactor_thread(void *arg) {
+    struct reactor *r = (struct reactor *) arg;
+    while (!atomic_load(&s_stop)) mg_mgr_poll(r->mgr, 1000);
+    return NULL;
+}
+
+static bool reactor_setup(int i, struct mg_mgr *mgr) {
+    struct reactor *r = &s_reactors[i];
+    r->mgr = mgr;
+    return web_queue_init(&r->queue, mgr, WEBSERVER_REACTOR_QUEUE,
+                          sizeof(struct bcast *), broadcast_cb, r);
+}
+
+// Undo reactor_setup() for reactors 1..N-1; their thread is not running
+static void reactor_teardown(struct reactor *r) {
+    web_queue_free(&r->queue);
+    mg_mgr_free(&r->own);
+    r->mgr = NULL;
+}
+
+struct mg_connection *web_listen(struct mg_mgr *mgr, const char *url,
+                                 mg_event_handler_t fn, void *fn_data) {
+    if (!atomic_load(&s_started) && s_nlisteners < MAX_LISTENERS) {
+        struct listener *l = &s_listeners[s_nlisteners++];
+        l->url = url, l->fn = fn, l->fn_data = fn_data;
+    }
+    return listen_reuseport(mgr, url, fn, fn_data);
+}
+
+void web_reactors_start(struct mg_mgr *mgr) {
+    int i, j, n = 1;
+
+    if (!reactor_setup(0, mgr)) {
+        MG_ERROR(("Reactor: setup failed, running single-threaded"));
+        return;
+    }
+    // Set up every reactor before any thread runs, so broadcasts from the
+    // new threads only ever see a complete table
+    for (i = 1; i < WEBSERVER_REACTORS; i++) {
+        struct reactor *r = &s_reactors[i];
+        mg_mgr_init(&r->own);
+        if (!reactor_setup(i, &r->own)) {
+            reactor_teardown(r);
+            continue;
+        }
+        for (j = 0; j < s_nlisteners; j++) {
+            listen_reuseport(r->mgr, s_listeners[j].url, s_listeners[j].fn,
+                             s_listeners[j].fn_data);
+        }
+    }
+    for (i = 1; i < WEBSERVER_REACTORS; i++) {
+        struct reactor *r = &s_reactors[i];
+        if (r->mgr == NULL) continue;
+        if (pthread_create(&r->thread, NULL, reactor_thread, r) == 0) {
+            r->running = true;
+            n++;
+        } else {
+            reactor_teardown(r);
+        }
+    }
+    // Broadcasts start once the table is final; until then the threads
+    // already running only serve their own clients
+    atomic_store(&s_started, true);
+    MG_INFO(("Reactors: %d running", n));
+}
+
+void web_reactors_stop(void) {
+    int i;
+
+    if (!atomic_load(&s_started)) return;
+    atomic_store(&s_stop, true);
+    for (i = 1; i < WEBSERVER_REACTORS; i++) {
+        struct reactor *r = &s_reactors[i];
+        if (!r->running) continue;
+        mg_wakeup(r->mgr, atomic_load(&r->queue.conn_id), "", 0);
+        pthread_join(r->thread, NULL);
+        r->running = false;
+    }
+    // Only this thread is left: hand out pending broadcasts, then close
+    atomic_store(&s_started, false);
+    web_queue_free(&s_reactors[0].queue);
+    for (i = 1; i < WEBSERVER_REACTORS; i++) {
+        if (s_reactors[i].mgr != NULL) reactor_teardown(&s_reactors[i]);
+    }
+    s_reactors[0].mgr = NULL;
+    MG_INFO(("Reactors: stopped"));
+}
+
+void web_reactors_broadcast(struct mg_mgr *from, const char *json) {
+    size_t len = strlen(json);
+    struct bcast *b;
+    int i, n = 0;
+
+    if (!atomic_load(&s_started)) return;
+    if ((b = (struct bcast *) mg_calloc(1, sizeof(*b) + len + 1)) == NULL) {
+        return;
+    }
+    memcpy(b->json, json, len);
+    // Start with a reference per reactor, give back those not posted to
+    atomic_init(&b->refs, WEBSERVER_REACTORS);
+    for (i = 0; i < WEBSERVER_REACTORS; i++) {
+        struct reactor *r = &s_reactors[i];
+        if (r->mgr == NULL || r->mgr == from ||
+            !web_queue_push(&r->queue, &b, sizeof(b))) {
+            n++;
+        }
+    }
+    if (n > 0 && atomic_fetch_sub(&b->refs, n) == n) mg_free(b);
+}
+
+#else  // WEBSERVER_REACTORS == 1
+
+struct mg_connection *web_listen(struct mg_mgr *mgr, const char *url,
+                                 mg_event_handler_t fn, void *fn_data) {
+    return mg_http_listen(mgr, url, fn, fn_data);
+}
+
+void web_reactors_start(struct mg_mgr *mgr) {
+    (void) mgr;
+}
+
+void web_reactors_stop(void) {
+}
+
+void web_reactors_broadcast(struct mg_mgr *from, const char *json) {
+    (void) from, (void) json;
+}
+
+#endif
@@ -0,0 +1,69 @@
+// Copyright (c) 2026
+// Web Server Reactors - Optional multi-threaded event loops (Linux)
+#pragma once
+
+#include "mongoose.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------------
+// Configuration
+// -----------------------------------------------------------------------------
+#ifndef WEBSERVER_REACTORS
+#define WEBSERVER_REACTORS 1          // Event loops, each on its own thread
+#endif
+
+#ifndef WEBSERVER_REACTOR_QUEUE
+#define WEBSERVER_REACTOR_QUEUE 64    // Pending broadcasts per loop
+#endif
+
+#if WEBSERVER_REACTORS > 1 && !defined(__linux__)
+#error "WEBSERVER_REACTORS > 1 needs Linux (SO_REUSEPORT, pthreads)"
+#endif
+
+// -----------------------------------------------------------------------------
+// Multi-reactor mode
+// -----------------------------------------------------------------------------
+// With WEBSERVER_REACTORS = N > 1, the loop in main.c becomes reactor 0 and
+// web_reactors_start() adds N - 1 more, each with its own mg_mgr (own epoll
+// fd, own timers) on its own thread. Every listener opened through
+// web_listen() is repeated on each reactor with SO_REUSEPORT, so the kernel
+// spreads incoming connections across them. A connection then stays on its
+// reactor for life.
+//
+// Socket I/O, HTTP parsing and file streaming run in parallel. Everything
+// that touches shared web state - the event handler, glue timers, and
+// mg_fs callbacks over glue data - runs under web_lock(), a recursive mutex.
+// ws_broadcast() reaches the other reactors through their web_queue.
+//
+// With one reactor all of this compiles down to plain mg_http_listen() and
+// no-op locks.
+
+// mg_http_listen(), with SO_REUSEPORT when there are several reactors.
+// Call from web_init(); the listener is repeated on every reactor.
+struct mg_connection *web_listen(struct mg_mgr *mgr, const char *url,
+                                 mg_event_handler_t fn, void *fn_data);
+
+// Start reactors 1..N-1 after web_init(mgr); returns immediately
+void web_reactors_start(struct mg_mgr *mgr);
+
+// Stop and join reactors 1..N-1 and free their managers; call from the
+// main loop's thread before mg_mgr_free() of reactor 0
+void web_reactors_stop(void);
+
+// Hand json to the WebSocket clients of every reactor except from's
+void web_reactors_broadcast(struct mg_mgr *from, const char *json);
+
+#if WEBSERVER_REACTORS > 1
+void web_lock(void);
+void web_unlock(void);
+#else
+#define web_lock()
+#define web_unlock()
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,68 @@
+// Copyright (c) 2026
+// Web Server Snapshot - Seqlock-published device state
+
+#include "webserver_snapshot.h"
+
+#define NWORDS(size) (((size) + 3) / 4)
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+bool web_snapshot_init(struct web_snapshot *s, size_t size) {
+    size_t i, n = NWORDS(size);
+
+    memset(s, 0, sizeof(*s));
+    s->words = (_Atomic uint32_t *) mg_calloc(n, sizeof(*s->words));
+    if (s->words == NULL) return false;
+    for (i = 0; i < n; i++) atomic_init(&s->words[i], 0);
+    atomic_init(&s->seq, 0);
+    s->size = size;
+    return true;
+}
+
+void web_snapshot_write(struct web_snapshot *s, const void *data) {
+    const uint8_t *p = (const uint8_t *) data;
+    unsigned seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    size_t i, n = NWORDS(s->size);
+
+    // Become the only writer: move seq from even to odd
+    for (;;) {
+        if ((seq & 1) == 0 &&
+            atomic_compare_exchange_weak_explicit(&s->seq, &seq, seq + 1,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            break;
+        }
+        seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    }
+    atomic_thread_fence(memory_order_release);  // Odd seq before the data
+
+    for (i = 0; i < n; i++) {
+        uint32_t w = 0;
+        size_t len = i + 1 < n ? 4 : s->size - i * 4;
+        memcpy(&w, p + i * 4, len);
+        atomic_store_explicit(&s->words[i], w, memory_order_relaxed);
+    }
+    atomic_store_explicit(&s->seq, seq + 2, memory_order_release);
+}
+
+void web_snapshot_read(struct web_snapshot *s, void *data) {
+    uint8_t *p = (uint8_t *) data;
+    size_t i, n = NWORDS(s->size);
+
+    for (;;) {
+        unsigned seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+        if ((seq & 1) == 0) {
+            for (i = 0; i < n; i++) {
+                uint32_t w = atomic_load_explicit(&s->words[i],
+                                                  memory_order_relaxed);
+                size_t len = i + 1 < n ? 4 : s->size - i * 4;
+                memcpy(p + i * 4, &w, len);
+            }
+            atomic_thread_fence(memory_order_acquire);  // Data before re-check
+            if (atomic_load_explicit(&s->seq, memory_order_relaxed) == seq) {
+                return;
+            }
+        }
+    }
+}
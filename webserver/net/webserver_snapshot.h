@@ -0,0 +1,41 @@
+// Copyright (c) 2026
+// Web Server Snapshot - Seqlock-published device state
+#pragma once
+
+#include "mongoose.h"
+
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------------
+// Snapshot state
+// -----------------------------------------------------------------------------
+// A fixed-size struct written by device tasks and read by HTTP/WebSocket
+// handlers, guarded by a sequence lock:
+//   - writers bump seq to odd, store the data, bump seq to even; several
+//     writers serialize on seq among themselves only
+//   - readers copy the data and retry if seq was odd or changed meanwhile,
+//     so they never block a writer and never see a half-written struct
+// Data is held as 32-bit atomic words copied with relaxed ordering, which
+// keeps concurrent access well defined in C11.
+struct web_snapshot {
+    atomic_uint seq;                // Even = stable, odd = write in progress
+    size_t size;                    // Bytes of user data
+    _Atomic uint32_t *words;        // (size + 3) / 4 words
+};
+
+// Allocate storage for size bytes, initially zero
+bool web_snapshot_init(struct web_snapshot *s, size_t size);
+
+// Publish size bytes from data; any thread
+void web_snapshot_write(struct web_snapshot *s, const void *data);
+
+// Copy a consistent snapshot into data; any thread, never blocks writers
+void web_snapshot_read(struct web_snapshot *s, void *data);
+
+#ifdef __cplusplus
+}
+#endif
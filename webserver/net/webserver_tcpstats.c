@@ -0,0 +1,160 @@
+// Copyright (c) 2026
+// Web Server TCP Stats - Per-connection transport counters for /api/debug
+
+#include "webserver_tcpstats.h"
+
+#if defined(__linux__) && MG_ENABLE_SOCKET
+#define TCPSTATS_TCP_INFO 1
+#else
+#define TCPSTATS_TCP_INFO 0
+#endif
+
+#if MG_ARCH == MG_ARCH_UNIX
+#include <time.h>
+#endif
+
+// Mongoose finds its Content-Length counter by rounding down to a size_t
+_Static_assert(MG_DATA_SIZE % sizeof(size_t) == 0,
+               "MG_DATA_SIZE must be a multiple of sizeof(size_t)");
+
+#if TCPSTATS_TCP_INFO
+// Kernel struct tcp_info (linux/tcp.h) up to tcpi_snd_wnd; glibc's copy
+// stops at tcpi_total_retrans. The kernel fills as much as it has and
+// reports the length, so older kernels just leave the tail unset.
+struct kernel_tcp_info {
+    uint8_t state, ca_state, retransmits, probes, backoff, options;
+    uint8_t wscale, app_limited;
+    uint32_t rto, ato, snd_mss, rcv_mss;
+    uint32_t unacked, sacked, lost, retrans, fackets;
+    uint32_t last_data_sent, last_ack_sent, last_data_recv, last_ack_recv;
+    uint32_t pmtu, rcv_ssthresh, rtt, rttvar, snd_ssthresh, snd_cwnd;
+    uint32_t advmss, reordering, rcv_rtt, rcv_space, total_retrans;
+    uint64_t pacing_rate, max_pacing_rate, bytes_acked, bytes_received;
+    uint32_t segs_out, segs_in, notsent_bytes, min_rtt;
+    uint32_t data_segs_in, data_segs_out;
+    uint64_t delivery_rate, busy_time, rwnd_limited, sndbuf_limited;
+    uint32_t delivered, delivered_ce;
+    uint64_t bytes_sent, bytes_retrans;
+    uint32_t dsack_dups, reord_seen, rcv_ooopack, snd_wnd;
+};
+
+#define HAS(len, field) \
+    ((len) >= offsetof(struct kernel_tcp_info, field) + \
+                  sizeof(((struct kernel_tcp_info *) 0)->field))
+
+static void tcpstats_kernel(struct mg_connection *c, struct web_tcpstats *st) {
+    struct kernel_tcp_info ti;
+    socklen_t len = sizeof(ti);
+    int fd = (int) (size_t) c->fd;
+
+    memset(&ti, 0, sizeof(ti));
+    if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &ti, &len) != 0 ||
+        !HAS(len, total_retrans)) {
+        return;
+    }
+    st->has_tcp_info = true;
+    st->retrans = ti.total_retrans;
+    st->unacked = ti.unacked;
+    st->rtt_us = ti.rtt;
+    st->rttvar_us = ti.rttvar;
+    st->cwnd = ti.snd_cwnd * ti.snd_mss;
+    st->rcv_space = ti.rcv_space;
+    if (HAS(len, segs_in)) {
+        st->bytes_in = ti.bytes_received;
+        st->bytes_out = ti.bytes_acked;
+        st->segs_in = ti.segs_in;
+        st->segs_out = ti.segs_out;
+    }
+    if (HAS(len, notsent_bytes)) st->notsent = ti.notsent_bytes;
+    if (HAS(len, snd_wnd)) st->snd_wnd = ti.snd_wnd;
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+uint64_t web_tcpstats_clock(void) {
+#if MG_ARCH == MG_ARCH_UNIX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + (uint64_t) ts.tv_nsec / 1000;
+#else
+    return mg_millis() * 1000;
+#endif
+}
+
+void web_tcpstats_account(struct mg_connection *c, int ev, void *ev_data,
+                          uint64_t start) {
+    struct web_tcpmeter *m = WEB_TCPMETER(c);
+
+    if (c->is_listening) return;
+    // Socket builds pass a long, the builtin stack a size_t: same width
+    if (ev == MG_EV_READ) {
+        m->bytes_in += (uint32_t) *(long *) ev_data;
+    } else if (ev == MG_EV_WRITE) {
+        m->bytes_out += (uint32_t) *(long *) ev_data;
+    }
+    m->busy_us += (uint32_t) (web_tcpstats_clock() - start);
+}
+
+bool web_tcpstats_get(struct mg_connection *c, struct web_tcpstats *st) {
+    struct web_tcpmeter *m = WEB_TCPMETER(c);
+
+    if (c->is_udp || c->is_listening || !(c->is_accepted || c->is_client)) {
+        return false;
+    }
+    memset(st, 0, sizeof(*st));
+    st->id = c->id;
+    st->rem = c->rem;
+    st->bytes_in = m->bytes_in;
+    st->bytes_out = m->bytes_out;
+    st->busy_us = m->busy_us;
+    st->recv_q = c->recv.len;
+    st->send_q = c->send.len;
+#if TCPSTATS_TCP_INFO
+    tcpstats_kernel(c, st);
+#endif
+    return true;
+}
+
+size_t web_tcpstats_print(void (*out)(char, void *), void *arg, va_list *ap) {
+    struct mg_mgr *mgr = va_arg(*ap, struct mg_mgr *);
+    struct web_tcpstats st;
+    struct mg_connection *c;
+    size_t n = 0;
+    int count = 0;
+
+    n += mg_xprintf(out, arg, "[");
+    for (c = mgr->conns; c != NULL && count < WEBSERVER_TCPSTATS_MAX; c = c->next) {
+        if (!web_tcpstats_get(c, &st)) continue;
+        n += mg_xprintf(out, arg,
+                        "%s{%m:%lu,%m:\"%M\",%m:%d,%m:%llu,%m:%llu,%m:%lu,"
+                        "%m:%lu,%m:%lu",
+                        count++ > 0 ? "," : "", MG_ESC("id"), st.id,
+                        MG_ESC("ip"), mg_print_ip, &st.rem, MG_ESC("port"),
+                        (int) mg_ntohs(st.rem.port), MG_ESC("bytes_in"),
+                        (unsigned long long) st.bytes_in, MG_ESC("bytes_out"),
+                        (unsigned long long) st.bytes_out, MG_ESC("recv_q"),
+                        (unsigned long) st.recv_q, MG_ESC("send_q"),
+                        (unsigned long) st.send_q, MG_ESC("busy_us"),
+                        (unsigned long) st.busy_us);
+        if (st.has_tcp_info) {
+            n += mg_xprintf(out, arg,
+                            ",%m:%lu,%m:%lu,%m:%lu,%m:%lu,%m:%lu,%m:%lu,"
+                            "%m:%lu,%m:%lu,%m:%lu,%m:%lu",
+                            MG_ESC("segs_in"), (unsigned long) st.segs_in,
+                            MG_ESC("segs_out"), (unsigned long) st.segs_out,
+                            MG_ESC("retrans"), (unsigned long) st.retrans,
+                            MG_ESC("unacked"), (unsigned long) st.unacked,
+                            MG_ESC("rtt_us"), (unsigned long) st.rtt_us,
+                            MG_ESC("rttvar_us"), (unsigned long) st.rttvar_us,
+                            MG_ESC("cwnd"), (unsigned long) st.cwnd,
+                            MG_ESC("snd_wnd"), (unsigned long) st.snd_wnd,
+                            MG_ESC("rcv_space"), (unsigned long) st.rcv_space,
+                            MG_ESC("notsent"), (unsigned long) st.notsent);
+        }
+        n += mg_xprintf(out, arg, "}");
+    }
+    n += mg_xprintf(out, arg, "]");
+    return n;
+}
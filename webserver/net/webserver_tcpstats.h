@@ -0,0 +1,81 @@
+// Copyright (c) 2026
+// Web Server TCP Stats - Per-connection transport counters for /api/debug
+#pragma once
+
+#include "mongoose.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------------
+// Configuration
+// -----------------------------------------------------------------------------
+#ifndef WEBSERVER_TCPSTATS_MAX
+#define WEBSERVER_TCPSTATS_MAX 16     // Connections listed per report
+#endif
+
+// -----------------------------------------------------------------------------
+// Connection meter
+// -----------------------------------------------------------------------------
+// Kept in c->data just before the last size_t, which Mongoose's file
+// serving uses for the remaining Content-Length, and updated by the event
+// handler on every event: two clock reads and a few adds. Protocol state
+// stored in c->data must fit in WEB_TCPMETER_ROOM bytes (CMake sets
+// MG_DATA_SIZE). Handlers of other TCP connections on the same manager,
+// such as device links, must leave those bytes alone and call
+// web_tcpstats_account() too.
+struct web_tcpmeter {
+    uint32_t bytes_in;    // Read from the network, mod 2^32
+    uint32_t bytes_out;   // Written to the network, mod 2^32
+    uint32_t busy_us;     // Time spent in the event handler
+};
+
+#define WEB_TCPMETER_ROOM \
+    (MG_DATA_SIZE - sizeof(size_t) - sizeof(struct web_tcpmeter))
+#define WEB_TCPMETER(c) \
+    ((struct web_tcpmeter *) ((c)->data + WEB_TCPMETER_ROOM))
+
+// Monotonic microseconds, for timing event handlers
+uint64_t web_tcpstats_clock(void);
+
+// Charge one event to c's meter; start is web_tcpstats_clock() taken
+// before the handler ran. Listeners are skipped: on the builtin stack
+// their c->data holds Mongoose's accept backlog.
+void web_tcpstats_account(struct mg_connection *c, int ev, void *ev_data,
+                          uint64_t start);
+
+// -----------------------------------------------------------------------------
+// Snapshot
+// -----------------------------------------------------------------------------
+// The meter and queue depths are available in every build. On Linux
+// sockets, TCP_INFO adds the kernel's view (read only when a report is
+// made); the builtin TCP/IP stack keeps its state private, so those
+// fields stay zero there and has_tcp_info is false.
+struct web_tcpstats {
+    unsigned long id;
+    struct mg_addr rem;
+    uint64_t bytes_in, bytes_out;  // TCP_INFO received/acked, else the meter
+    uint32_t busy_us;
+    size_t recv_q, send_q;         // Bytes in c->recv / c->send
+    bool has_tcp_info;
+    uint32_t segs_in, segs_out;
+    uint32_t retrans;              // Segments retransmitted, total
+    uint32_t unacked;              // Segments in flight
+    uint32_t rtt_us, rttvar_us;    // Smoothed RTT and its variation
+    uint32_t cwnd;                 // Congestion window, bytes
+    uint32_t snd_wnd;              // Peer's receive window, bytes, 0 = unknown
+    uint32_t rcv_space;            // Our receive window estimate, bytes
+    uint32_t notsent;              // Bytes in the kernel not yet sent
+};
+
+// Fill st for a TCP connection; false for listeners, UDP and the like
+bool web_tcpstats_get(struct mg_connection *c, struct web_tcpstats *st);
+
+// %M printer: JSON array with the stats of the TCP connections of a
+// struct mg_mgr *, at most WEBSERVER_TCPSTATS_MAX of them
+size_t web_tcpstats_print(void (*out)(char, void *), void *arg, va_list *ap);
+
+#ifdef __cplusplus
+}
+#endif
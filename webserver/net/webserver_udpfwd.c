@@ -0,0 +1,276 @@
+// Copyright (c) 2026
+// Web Server UDP Forward - Batched mirror of bus traffic for packet capture
+
+#define _GNU_SOURCE  // sendmmsg()
+
+#include "webserver_udpfwd.h"
+#include "webserver_queue.h"
+
+#include <stdatomic.h>
+
+#if defined(__linux__) && MG_ENABLE_SOCKET
+#define UDPFWD_SENDMMSG 1
+#include <sys/socket.h>
+#else
+#define UDPFWD_SENDMMSG 0
+#endif
+
+#define DGRAM_HDR 8
+#define REC_HDR 8
+#define MAX_RECORDS 255
+
+#if DGRAM_HDR + REC_HDR + WEBSERVER_UDPFWD_FRAME > WEBSERVER_UDPFWD_DGRAM
+#error "WEBSERVER_UDPFWD_FRAME does not fit in WEBSERVER_UDPFWD_DGRAM"
+#endif
+
+// Queue item: a record header in host order, then len bytes of data
+struct frame {
+    uint8_t ch, flags;
+    uint16_t len;
+    uint32_t ms;
+    uint8_t data[WEBSERVER_UDPFWD_FRAME];
+};
+
+// Datagram being filled or waiting for the next burst
+struct dgram {
+    int ch;
+    size_t len;
+    uint8_t buf[WEBSERVER_UDPFWD_DGRAM];
+};
+
+static struct web_queue s_queue;
+static bool s_ok = false;
+static atomic_uint s_mask;
+static _Atomic uint32_t s_ip;               // Target, network order, 0 = none
+
+// Event loop side: datagrams of the current burst, and per channel the
+// one still accepting records (1 + index into s_out, 0 = none)
+static struct dgram s_out[WEBSERVER_UDPFWD_BURST];
+static size_t s_nout = 0;
+static size_t s_open[WEB_UDPFWD_CHANNELS];
+static uint32_t s_seq[WEB_UDPFWD_CHANNELS];
+
+// Read by /api/debug from any reactor
+static struct {
+    atomic_ulong frames, datagrams, sends, dropped, truncated, send_errors;
+} s_stats;
+
+#if UDPFWD_SENDMMSG
+static int s_sock = -1;
+#else
+static struct mg_mgr *s_mgr;
+static struct mg_connection *s_conns[WEB_UDPFWD_CHANNELS];
+static uint32_t s_conns_ip;                 // Target s_conns point to
+#endif
+
+static void count(atomic_ulong *counter, unsigned long n) {
+    atomic_fetch_add_explicit(counter, n, memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// Sending
+// -----------------------------------------------------------------------------
+// Send s_out[0..s_nout) in order, stop at the first failure. Returns the
+// number of datagrams sent.
+#if UDPFWD_SENDMMSG
+// One system call for the whole burst. The socket is non-blocking: when
+// its buffer is full the rest of the burst is dropped rather than stall
+// the event loop.
+static size_t udpfwd_send(uint32_t ip) {
+    struct mmsghdr msgs[WEBSERVER_UDPFWD_BURST];
+    struct iovec iov[WEBSERVER_UDPFWD_BURST];
+    struct sockaddr_in sin[WEBSERVER_UDPFWD_BURST];
+    size_t i, sent = 0;
+
+    memset(msgs, 0, sizeof(msgs[0]) * s_nout);
+    memset(sin, 0, sizeof(sin[0]) * s_nout);
+    for (i = 0; i < s_nout; i++) {
+        sin[i].sin_family = AF_INET;
+        sin[i].sin_addr.s_addr = ip;
+        sin[i].sin_port = mg_htons((uint16_t) (WEBSERVER_UDPFWD_PORT + s_out[i].ch));
+        iov[i].iov_base = s_out[i].buf;
+        iov[i].iov_len = s_out[i].len;
+        msgs[i].msg_hdr.msg_name = &sin[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(sin[i]);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    while (sent < s_nout) {
+        int n = sendmmsg(s_sock, msgs + sent, (unsigned) (s_nout - sent), 0);
+        count(&s_stats.sends, 1);
+        if (n <= 0) break;
+        sent += (size_t) n;
+    }
+    return sent;
+}
+#else
+// A UDP connection per channel, opened on first use. On the builtin stack
+// mg_send() puts each datagram on the wire at once, so the burst leaves in
+// one pass of the event loop.
+static void udpfwd_conn_ev(struct mg_connection *c, int ev, void *ev_data) {
+    int ch = (int) (size_t) c->fn_data;
+    if (ev == MG_EV_CLOSE && s_conns[ch] == c) s_conns[ch] = NULL;
+    (void) ev_data;
+}
+
+static size_t udpfwd_send(uint32_t ip) {
+    size_t i;
+
+    if (ip != s_conns_ip) {
+        for (i = 0; i < WEB_UDPFWD_CHANNELS; i++) {
+            if (s_conns[i] != NULL) s_conns[i]->is_closing = 1;
+            s_conns[i] = NULL;
+        }
+        s_conns_ip = ip;
+    }
+    for (i = 0; i < s_nout; i++) {
+        int ch = s_out[i].ch;
+        if (s_conns[ch] == NULL) {
+            char url[40];
+            mg_snprintf(url, sizeof(url), "udp://%M:%d", mg_print_ip4, &ip,
+                        WEBSERVER_UDPFWD_PORT + ch);
+            s_conns[ch] = mg_connect(s_mgr, url, udpfwd_conn_ev,
+                                     (void *) (size_t) ch);
+        }
+        count(&s_stats.sends, 1);
+        if (s_conns[ch] == NULL ||
+            !mg_send(s_conns[ch], s_out[i].buf, s_out[i].len)) {
+            break;
+        }
+    }
+    return i;
+}
+#endif
+
+// Send the burst and start an empty one
+static void udpfwd_flush(void) {
+    uint32_t ip = atomic_load_explicit(&s_ip, memory_order_relaxed);
+    size_t i, sent = ip == 0 ? 0 : udpfwd_send(ip);
+
+    for (i = 0; i < s_nout; i++) {
+        unsigned records = s_out[i].buf[3];
+        if (i < sent) {
+            count(&s_stats.datagrams, 1);
+            count(&s_stats.frames, records);
+        } else {
+            if (ip != 0) count(&s_stats.send_errors, 1);
+            count(&s_stats.dropped, records);
+        }
+    }
+    s_nout = 0;
+    memset(s_open, 0, sizeof(s_open));
+}
+
+// -----------------------------------------------------------------------------
+// Queue callbacks (event loop)
+// -----------------------------------------------------------------------------
+// Append a frame to its channel's open datagram, opening one if needed
+static void udpfwd_frame(const void *item, size_t len, void *arg) {
+    const struct frame *f = (const struct frame *) item;
+    struct dgram *d = s_open[f->ch] ? &s_out[s_open[f->ch] - 1] : NULL;
+    uint8_t *p;
+
+    if (d != NULL && (d->len + REC_HDR + f->len > sizeof(d->buf) ||
+                      d->buf[3] == MAX_RECORDS)) {
+        d = NULL;  // Full, it goes out with the burst
+    }
+    if (d == NULL) {
+        if (s_nout == WEBSERVER_UDPFWD_BURST) udpfwd_flush();
+        d = &s_out[s_nout++];
+        s_open[f->ch] = s_nout;
+        d->ch = f->ch;
+        d->buf[0] = 'U', d->buf[1] = 'F';
+        d->buf[2] = WEB_UDPFWD_VERSION, d->buf[3] = 0;
+        MG_STORE_BE32(d->buf + 4, s_seq[f->ch]);
+        s_seq[f->ch]++;
+        d->len = DGRAM_HDR;
+    }
+    p = d->buf + d->len;
+    p[0] = f->ch, p[1] = f->flags;
+    MG_STORE_BE16(p + 2, f->len);
+    MG_STORE_BE32(p + 4, f->ms);
+    memcpy(p + REC_HDR, f->data, f->len);
+    d->len += REC_HDR + f->len;
+    d->buf[3]++;
+    (void) len, (void) arg;
+}
+
+// End of a drain: whatever was captured meanwhile goes out now
+static void udpfwd_done(void *arg) {
+    if (s_nout > 0) udpfwd_flush();
+    (void) arg;
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+bool web_udpfwd_init(struct mg_mgr *mgr) {
+    atomic_init(&s_mask, 0);
+    if (!web_queue_init(&s_queue, mgr, WEBSERVER_UDPFWD_QUEUE,
+                        sizeof(struct frame), udpfwd_frame, NULL)) {
+        return false;
+    }
+    s_queue.done = udpfwd_done;
+#if UDPFWD_SENDMMSG
+    s_sock = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (s_sock < 0) {
+        MG_ERROR(("UDP forward: socket() failed, errno %d", errno));
+        return false;
+    }
+#else
+    s_mgr = mgr;
+#endif
+    s_ok = true;
+    return true;
+}
+
+bool web_udpfwd_set_target(const char *ip) {
+    struct mg_addr addr;
+    uint32_t ip4 = 0;
+
+    memset(&addr, 0, sizeof(addr));
+    if (mg_aton(mg_str(ip), &addr) && !addr.is_ip6) {
+        memcpy(&ip4, addr.ip, sizeof(ip4));
+    }
+    atomic_store_explicit(&s_ip, ip4, memory_order_relaxed);
+    return ip4 != 0;
+}
+
+void web_udpfwd_set_mask(unsigned mask) {
+    atomic_store_explicit(&s_mask, mask, memory_order_relaxed);
+}
+
+void web_udpfwd_capture(int channel, const void *data, size_t len) {
+    struct frame f;
+
+    if (!s_ok || channel < 0 || channel >= WEB_UDPFWD_CHANNELS ||
+        (atomic_load_explicit(&s_mask, memory_order_relaxed) &
+         (1U << channel)) == 0) {
+        return;
+    }
+    f.ch = (uint8_t) channel;
+    f.flags = channel != WEB_UDPFWD_LOG && (channel & 1) ? WEB_UDPFWD_FLAG_TX : 0;
+    if (len > sizeof(f.data)) {
+        len = sizeof(f.data);
+        f.flags |= WEB_UDPFWD_FLAG_TRUNCATED;
+        count(&s_stats.truncated, 1);
+    }
+    f.len = (uint16_t) len;
+    f.ms = (uint32_t) mg_millis();
+    memcpy(f.data, data, len);
+    web_queue_push(&s_queue, &f, offsetof(struct frame, data) + len);
+}
+
+void web_udpfwd_get_stats(struct web_udpfwd_stats *st) {
+    struct web_queue_stats qs;
+
+    web_queue_get_stats(&s_queue, &qs);
+    st->frames = atomic_load_explicit(&s_stats.frames, memory_order_relaxed);
+    st->datagrams = atomic_load_explicit(&s_stats.datagrams, memory_order_relaxed);
+    st->sends = atomic_load_explicit(&s_stats.sends, memory_order_relaxed);
+    st->dropped = qs.dropped +
+                  atomic_load_explicit(&s_stats.dropped, memory_order_relaxed);
+    st->truncated = atomic_load_explicit(&s_stats.truncated, memory_order_relaxed);
+    st->send_errors = atomic_load_explicit(&s_stats.send_errors,
+                                           memory_order_relaxed);
+}
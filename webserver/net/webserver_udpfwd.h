@@ -0,0 +1,92 @@
+// Copyright (c) 2026
+// Web Server UDP Forward - Batched mirror of bus traffic for packet capture
+#pragma once
+
+#include "mongoose.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------------
+// Configuration
+// -----------------------------------------------------------------------------
+#ifndef WEBSERVER_UDPFWD_PORT
+#define WEBSERVER_UDPFWD_PORT 5002    // Port of channel 0, one port per channel
+#endif
+
+#ifndef WEBSERVER_UDPFWD_QUEUE
+#define WEBSERVER_UDPFWD_QUEUE 256    // Captured frames awaiting the event loop
+#endif
+
+#ifndef WEBSERVER_UDPFWD_FRAME
+#define WEBSERVER_UDPFWD_FRAME 256    // Longer frames are truncated
+#endif
+
+#ifndef WEBSERVER_UDPFWD_DGRAM
+#define WEBSERVER_UDPFWD_DGRAM 1400   // Datagram size limit, below path MTU
+#endif
+
+#ifndef WEBSERVER_UDPFWD_BURST
+#define WEBSERVER_UDPFWD_BURST 16     // Datagrams handed to one sendmmsg()
+#endif
+
+// -----------------------------------------------------------------------------
+// Channels
+// -----------------------------------------------------------------------------
+// In port order: channel ch goes to WEBSERVER_UDPFWD_PORT + ch
+enum web_udpfwd_channel {
+    WEB_UDPFWD_TOOL_RX, WEB_UDPFWD_TOOL_TX,
+    WEB_UDPFWD_SCREEN_RX, WEB_UDPFWD_SCREEN_TX,
+    WEB_UDPFWD_OP1_RX, WEB_UDPFWD_OP1_TX,
+    WEB_UDPFWD_OP2_RX, WEB_UDPFWD_OP2_TX,
+    WEB_UDPFWD_MBTCP1_RX, WEB_UDPFWD_MBTCP1_TX,
+    WEB_UDPFWD_MBTCP2_RX, WEB_UDPFWD_MBTCP2_TX,
+    WEB_UDPFWD_MBTCP3_RX, WEB_UDPFWD_MBTCP3_TX,
+    WEB_UDPFWD_LOG,
+    WEB_UDPFWD_CHANNELS
+};
+
+// -----------------------------------------------------------------------------
+// Wire format
+// -----------------------------------------------------------------------------
+// Frames captured on the same channel are packed into one datagram, all
+// fields big-endian:
+//
+//   datagram: 'U' 'F' version(1) count(1) seq(4)   record * count
+//   record:   channel(1) flags(1) len(2) time_ms(4) data(len)
+//
+// seq counts datagrams per channel, so a gap shows a datagram lost on the
+// way. flags: bit 0 = sent by the device (tx), bit 1 = data truncated.
+// time_ms is mg_millis() at capture, modulo 2^32.
+#define WEB_UDPFWD_VERSION 1
+#define WEB_UDPFWD_FLAG_TX 1
+#define WEB_UDPFWD_FLAG_TRUNCATED 2
+
+struct web_udpfwd_stats {
+    uint64_t frames;          // Frames packed into datagrams
+    uint64_t datagrams;       // Datagrams sent
+    uint64_t sends;           // sendmmsg()/mg_send() calls
+    uint64_t dropped;         // Frames lost: queue full or send failed
+    uint64_t truncated;       // Frames cut to WEBSERVER_UDPFWD_FRAME
+    uint64_t send_errors;     // Datagrams the network refused
+};
+
+// Start the forwarder on mgr's event loop; call from web_init()
+bool web_udpfwd_init(struct mg_mgr *mgr);
+
+// Send to this IPv4 address; false (and forwarding paused) if it is invalid
+bool web_udpfwd_set_target(const char *ip);
+
+// Enable the channels whose bit (1 << channel) is set; any thread
+void web_udpfwd_set_mask(unsigned mask);
+
+// Mirror one frame on a channel; any thread, never blocks. Frames of
+// disabled channels are ignored at the cost of one atomic load.
+void web_udpfwd_capture(int channel, const void *data, size_t len);
+
+void web_udpfwd_get_stats(struct web_udpfwd_stats *st);
+
+#ifdef __cplusplus
+}
+#endif
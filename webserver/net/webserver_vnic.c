@@ -0,0 +1,206 @@
+// Copyright (c) 2026
+// Web Server Virtual NIC - In-memory Ethernet driver for the builtin TCP/IP stack
+
+#include "webserver_vnic.h"
+
+#if MG_ENABLE_TCPIP
+
+#define PCAP_MAGIC 0xa1b2c3d4U
+#define PCAP_LINKTYPE_ETHERNET 1
+
+struct pcap_hdr {
+    uint32_t magic;
+    uint16_t major, minor;
+    int32_t zone;
+    uint32_t sigfigs, snaplen, linktype;
+};
+
+struct pcap_rec {
+    uint32_t sec, usec, incl_len, orig_len;
+};
+
+// xorshift32, enough to spread losses over a run
+static unsigned vnic_rand(struct web_vnic *v) {
+    uint32_t x = v->rand;
+    x ^= x << 13, x ^= x >> 17, x ^= x << 5;
+    return (v->rand = x) % 1000;
+}
+
+static void vnic_record(struct web_vnic *v, const void *buf, size_t len,
+                        uint64_t ms) {
+    struct pcap_rec r;
+    if (v->capture == NULL) return;
+    r.sec = (uint32_t) (ms / 1000), r.usec = (uint32_t) (ms % 1000) * 1000;
+    r.incl_len = r.orig_len = (uint32_t) len;
+    v->fs->wr(v->capture, &r, sizeof(r));
+    v->fs->wr(v->capture, buf, len);
+}
+
+static bool vnic_alloc(struct web_vnic *v) {
+    if (v->slots == NULL) {
+        v->slots = (struct web_vnic_slot *) mg_calloc(WEB_VNIC_SLOTS,
+                                                      sizeof(*v->slots));
+    }
+    return v->slots != NULL;
+}
+
+// Put a frame on the wire towards v
+static void vnic_enqueue(struct web_vnic *from, struct web_vnic *v,
+                         const void *buf, size_t len, uint64_t now) {
+    struct web_vnic_slot *s = NULL, *prev = NULL;
+    int i;
+
+    for (i = 0; i < WEB_VNIC_SLOTS; i++) {
+        struct web_vnic_slot *t = &v->slots[i];
+        if (t->due == 0 && s == NULL) s = t;
+        if (t->due != 0 && t->seq == v->seq) prev = t;
+    }
+    if (s == NULL) {
+        from->stats.overflow++;
+        return;
+    }
+    memcpy(s->buf, buf, len);
+    s->len = len;
+    // Arrive in send order, no earlier than the newest frame on the wire...
+    s->due = now + from->opts.latency_ms;
+    if (s->due < v->last_due) s->due = v->last_due;
+    s->seq = ++v->seq;
+    v->last_due = s->due;
+    // ...unless this frame overtakes that one
+    if (prev != NULL && vnic_rand(from) < from->opts.reorder) {
+        uint64_t due = prev->due;
+        unsigned long seq = prev->seq;
+        prev->due = s->due, prev->seq = s->seq;
+        s->due = due, s->seq = seq;
+        from->stats.reordered++;
+    }
+}
+
+// Read the next capture record into slot 0, timed relative to the first one
+static void vnic_replay_next(struct web_vnic *v, uint64_t now) {
+    struct web_vnic_slot *s = &v->slots[0];
+    struct pcap_rec r;
+    uint64_t ms;
+
+    if (v->fs->rd(v->replay, &r, sizeof(r)) != sizeof(r) ||
+        r.incl_len > sizeof(s->buf) ||
+        v->fs->rd(v->replay, s->buf, r.incl_len) != r.incl_len) {
+        v->fs->cl(v->replay);
+        v->replay = NULL;
+        return;
+    }
+    ms = (uint64_t) r.sec * 1000 + r.usec / 1000;
+    if (v->replay_base == 0) v->replay_base = now - ms + 1;
+    s->len = r.incl_len;
+    s->due = v->replay_base + ms;
+}
+
+// -----------------------------------------------------------------------------
+// Driver callbacks
+// -----------------------------------------------------------------------------
+static bool vnic_init(struct mg_tcpip_if *ifp) {
+    struct web_vnic *v = (struct web_vnic *) ifp->driver_data;
+    return v != NULL && vnic_alloc(v);
+}
+
+static size_t vnic_tx(const void *buf, size_t len, struct mg_tcpip_if *ifp) {
+    struct web_vnic *v = (struct web_vnic *) ifp->driver_data;
+    size_t mtu = v->opts.mtu ? v->opts.mtu : MG_TCPIP_MTU_DEFAULT;
+    uint64_t now = mg_millis();
+
+    vnic_record(v, buf, len, now);
+    v->stats.sent++;
+    if (len > mtu + 14) {
+        v->stats.oversize++;
+    } else if (vnic_rand(v) < v->opts.loss) {
+        v->stats.lost++;
+    } else if (v->peer != NULL) {
+        vnic_enqueue(v, v->peer, buf, len, now);
+    }
+    return len;  // What the wire does with it is not the sender's business
+}
+
+static size_t vnic_rx(void *buf, size_t len, struct mg_tcpip_if *ifp) {
+    struct web_vnic *v = (struct web_vnic *) ifp->driver_data;
+    struct web_vnic_slot *s = NULL;
+    uint64_t now = mg_millis();
+    size_t n;
+    int i;
+
+    if (v->replay != NULL && v->slots[0].due == 0) vnic_replay_next(v, now);
+    for (i = 0; i < WEB_VNIC_SLOTS; i++) {
+        struct web_vnic_slot *t = &v->slots[i];
+        if (t->due == 0 || t->due > now) continue;
+        if (s == NULL || t->due < s->due || (t->due == s->due && t->seq < s->seq)) {
+            s = t;
+        }
+    }
+    if (s == NULL) return 0;
+    n = s->len < len ? s->len : len;
+    memcpy(buf, s->buf, n);
+    s->due = 0;
+    vnic_record(v, buf, n, now);
+    v->stats.delivered++;
+    return n;
+}
+
+static bool vnic_poll(struct mg_tcpip_if *ifp, bool s1) {
+    struct web_vnic *v = (struct web_vnic *) ifp->driver_data;
+    (void) s1;
+    return v->peer != NULL || v->replay != NULL;  // Link is up while wired
+}
+
+struct mg_tcpip_driver web_vnic_driver = {vnic_init, vnic_tx, vnic_rx,
+                                          vnic_poll};
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+bool web_vnic_pair(struct web_vnic *a, struct web_vnic *b,
+                   const struct web_vnic_opts *opts) {
+    if (!vnic_alloc(a) || !vnic_alloc(b)) return false;
+    a->peer = b, b->peer = a;
+    if (opts != NULL) a->opts = b->opts = *opts;
+    if (a->rand == 0) a->rand = 0x2545f491U;
+    if (b->rand == 0) b->rand = 0x9e3779b9U;
+    return true;
+}
+
+bool web_vnic_capture(struct web_vnic *v, struct mg_fs *fs, const char *path) {
+    struct pcap_hdr h = {PCAP_MAGIC, 2, 4, 0, 0, WEB_VNIC_FRAME,
+                         PCAP_LINKTYPE_ETHERNET};
+
+    fs->rm(path);  // mg_fs opens for append
+    if ((v->capture = fs->op(path, MG_FS_WRITE)) == NULL) return false;
+    v->fs = fs;
+    fs->wr(v->capture, &h, sizeof(h));
+    return true;
+}
+
+bool web_vnic_replay(struct web_vnic *v, struct mg_fs *fs, const char *path) {
+    struct pcap_hdr h;
+
+    if (!vnic_alloc(v) || (v->replay = fs->op(path, MG_FS_READ)) == NULL) {
+        return false;
+    }
+    v->fs = fs;
+    v->replay_base = 0;
+    if (fs->rd(v->replay, &h, sizeof(h)) != sizeof(h) || h.magic != PCAP_MAGIC ||
+        h.linktype != PCAP_LINKTYPE_ETHERNET) {
+        MG_ERROR(("%s: not an Ethernet pcap file", path));
+        fs->cl(v->replay);
+        v->replay = NULL;
+        return false;
+    }
+    return true;
+}
+
+void web_vnic_free(struct web_vnic *v) {
+    if (v->capture != NULL) v->fs->cl(v->capture);
+    if (v->replay != NULL) v->fs->cl(v->replay);
+    if (v->peer != NULL) v->peer->peer = NULL;
+    mg_free(v->slots);
+    memset(v, 0, sizeof(*v));
+}
+
+#endif  // MG_ENABLE_TCPIP
@@ -0,0 +1,96 @@
+// Copyright (c) 2026
+// Web Server Virtual NIC - In-memory Ethernet driver for the builtin TCP/IP stack
+#pragma once
+
+#include "mongoose.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if MG_ENABLE_TCPIP
+
+// -----------------------------------------------------------------------------
+// Configuration
+// -----------------------------------------------------------------------------
+#ifndef WEB_VNIC_SLOTS
+#define WEB_VNIC_SLOTS 64             // Frames on the wire per direction
+#endif
+
+#define WEB_VNIC_FRAME 1540           // Largest Ethernet frame
+
+// -----------------------------------------------------------------------------
+// Virtual NIC state
+// -----------------------------------------------------------------------------
+// Lets the builtin stack run on a host with no hardware. Two interfaces,
+// each on its own mg_mgr, are wired back to back: a frame one sends is
+// delivered to the other after opts.latency_ms, unless the simulated wire
+// drops it or lets it overtake the frame before. Alternatively a NIC can
+// be fed from a pcap file, and any NIC can capture what it sends and
+// receives to a pcap file for Wireshark.
+//
+//   static struct web_vnic va, vb;
+//   web_vnic_pair(&va, &vb, &opts);
+//   ifa.driver = &web_vnic_driver, ifa.driver_data = &va;
+//   mg_tcpip_init(&mgr_a, &ifa);    // Same for ifb / vb / mgr_b
+//
+// Both managers must be polled from the same thread. The stack takes one
+// received frame per mg_mgr_poll(), so poll with a 0 ms timeout.
+struct web_vnic_opts {
+    unsigned latency_ms;  // One-way delay
+    unsigned loss;        // Frames dropped, per thousand
+    unsigned reorder;     // Frames overtaking the previous one, per thousand
+    size_t mtu;           // Largest IP packet, bigger frames are dropped;
+                          // 0 = 1500. Set ifp->mtu to match.
+};
+
+struct web_vnic_stats {
+    unsigned long sent;       // Frames handed to the wire
+    unsigned long delivered;  // Frames received by this NIC
+    unsigned long lost;       // Dropped by opts.loss
+    unsigned long reordered;  // Delivered ahead of an earlier frame
+    unsigned long oversize;   // Dropped for exceeding opts.mtu
+    unsigned long overflow;   // Dropped because the peer had no free slot
+};
+
+struct web_vnic_slot {
+    uint64_t due;         // mg_millis() at which the frame arrives, 0 = free
+    unsigned long seq;    // Delivery order among frames due at once
+    size_t len;
+    uint8_t buf[WEB_VNIC_FRAME];
+};
+
+struct web_vnic {
+    struct web_vnic_opts opts;
+    struct web_vnic *peer;           // Receives what this NIC sends
+    struct web_vnic_slot *slots;     // Frames on their way to this NIC
+    uint64_t last_due;               // Arrival time of the newest frame
+    unsigned long seq;               // Order of the newest frame
+    uint32_t rand;                   // Loss/reorder generator state
+    struct mg_fs *fs;
+    void *capture;                   // pcap output, or NULL
+    void *replay;                    // pcap input, or NULL
+    uint64_t replay_base;            // mg_millis() - first capture timestamp
+    struct web_vnic_stats stats;
+};
+
+extern struct mg_tcpip_driver web_vnic_driver;
+
+// Wire a and b back to back; opts applies both ways, NULL for a perfect wire
+bool web_vnic_pair(struct web_vnic *a, struct web_vnic *b,
+                   const struct web_vnic_opts *opts);
+
+// Append every frame v sends or receives to a pcap file
+bool web_vnic_capture(struct web_vnic *v, struct mg_fs *fs, const char *path);
+
+// Feed v the frames of a pcap file at their recorded pace, instead of a peer
+bool web_vnic_replay(struct web_vnic *v, struct mg_fs *fs, const char *path);
+
+// Close files and release the slots of v
+void web_vnic_free(struct web_vnic *v);
+
+#endif  // MG_ENABLE_TCPIP
+
+#ifdef __cplusplus
+}
+#endif